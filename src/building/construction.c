@@ -18,6 +18,7 @@
 #include "core/image.h"
 #include "core/time.h"
 #include "figure/formation.h"
+#include "game/replay.h"
 #include "game/undo.h"
 #include "graphics/window.h"
 #include "map/aqueduct.h"
@@ -566,6 +567,7 @@ void building_construction_place(void)
     if (!type) {
         return;
     }
+    replay_record_command(REPLAY_COMMAND_CONSTRUCT, type, x_start, y_start, x_end, y_end, data.road_orientation);
     if (city_finance_out_of_money()) {
         map_property_clear_constructing_and_deleted();
         city_warning_show(WARNING_OUT_OF_MONEY);
@@ -748,6 +750,13 @@ int building_construction_road_orientation(void)
     return data.road_orientation;
 }
 
+void building_construction_set_road_orientation(int orientation)
+{
+    if (data.road_orientation > 0 && orientation > 0) {
+        data.road_orientation = orientation;
+    }
+}
+
 void building_construction_record_view_position(int view_x, int view_y, int grid_offset)
 {
     if (grid_offset == data.start.grid_offset) {
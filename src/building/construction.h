@@ -32,6 +32,12 @@ int building_construction_can_place_on_terrain(int x, int y, int *warning_id);
 void building_construction_update_road_orientation(void);
 int building_construction_road_orientation(void);
 
+/**
+ * Sets the orientation of a gatehouse or triumphal arch, which otherwise changes over time
+ * @param orientation 1 or 2, ignored for other buildings
+ */
+void building_construction_set_road_orientation(int orientation);
+
 void building_construction_record_view_position(int view_x, int view_y, int grid_offset);
 void building_construction_get_view_position(int *view_x, int *view_y);
 int building_construction_get_start_grid_offset(void);
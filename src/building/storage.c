@@ -1,6 +1,7 @@
 #include "storage.h"
 
 #include "building/building.h"
+#include "game/replay.h"
 
 #include <string.h>
 
@@ -78,11 +79,13 @@ const building_storage *building_storage_get(int storage_id)
 
 void building_storage_toggle_empty_all(int storage_id)
 {
+    replay_record_command(REPLAY_COMMAND_STORAGE_EMPTY_ALL, storage_id);
     data.storages[storage_id].storage.empty_all = 1 - data.storages[storage_id].storage.empty_all;
 }
 
 void building_storage_cycle_resource_state(int storage_id, resource_type resource_id)
 {
+    replay_record_command(REPLAY_COMMAND_STORAGE_CYCLE, storage_id, resource_id);
     int state = data.storages[storage_id].storage.resource_state[resource_id];
     if (state == BUILDING_STORAGE_STATE_ACCEPTING) {
         state = BUILDING_STORAGE_STATE_NOT_ACCEPTING;
@@ -96,6 +99,7 @@ void building_storage_cycle_resource_state(int storage_id, resource_type resourc
 
 void building_storage_accept_none(int storage_id)
 {
+    replay_record_command(REPLAY_COMMAND_STORAGE_ACCEPT_NONE, storage_id);
     for (int r = RESOURCE_MIN; r < RESOURCE_MAX; r++) {
         data.storages[storage_id].storage.resource_state[r] = BUILDING_STORAGE_STATE_NOT_ACCEPTING;
     }
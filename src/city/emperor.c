@@ -7,12 +7,19 @@
 #include "core/calc.h"
 #include "figure/formation.h"
 #include "game/difficulty.h"
+#include "game/replay.h"
 #include "game/time.h"
 #include "scenario/property.h"
 #include "scenario/invasion.h"
 
 const int SALARY_FOR_RANK[11] = {0, 2, 5, 8, 12, 20, 30, 40, 60, 80, 100};
 
+static void set_salary_rank(int rank)
+{
+    city_data.emperor.salary_rank = rank;
+    city_data.emperor.salary_amount = SALARY_FOR_RANK[rank];
+}
+
 void city_emperor_init_scenario(int rank)
 {
     city_data.ratings.favor = scenario_starting_favor();
@@ -27,7 +34,7 @@ void city_emperor_init_scenario(int rank)
     if (salary_rank > 10) {
         salary_rank = 10;
     }
-    city_emperor_set_salary_rank(salary_rank);
+    set_salary_rank(salary_rank);
 }
 
 static void update_debt_state(void)
@@ -205,6 +212,7 @@ void city_emperor_calculate_gift_costs(void)
 void city_emperor_send_gift(void)
 {
     int size = city_data.emperor.selected_gift_size;
+    replay_record_command(REPLAY_COMMAND_SEND_GIFT, size);
     if (size < GIFT_MODEST || size > GIFT_LAVISH) {
         return;
     }
@@ -274,8 +282,8 @@ int city_emperor_salary_for_rank(int rank)
 
 void city_emperor_set_salary_rank(int rank)
 {
-    city_data.emperor.salary_rank = rank;
-    city_data.emperor.salary_amount = SALARY_FOR_RANK[rank];
+    replay_record_command(REPLAY_COMMAND_SALARY, rank);
+    set_salary_rank(rank);
 }
 
 int city_emperor_salary_rank(void)
@@ -317,6 +325,7 @@ void city_emperor_change_donation_amount(int change)
 
 void city_emperor_donate_savings_to_city(void)
 {
+    replay_record_command(REPLAY_COMMAND_DONATE, city_data.emperor.donate_amount);
     city_finance_process_donation(city_data.emperor.donate_amount);
     city_data.emperor.personal_savings -= city_data.emperor.donate_amount;
     city_finance_calculate_totals();
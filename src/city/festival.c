@@ -6,6 +6,7 @@
 #include "city/finance.h"
 #include "city/message.h"
 #include "city/sentiment.h"
+#include "game/replay.h"
 
 int city_festival_is_planned(void)
 {
@@ -68,6 +69,7 @@ int city_festival_select_size(int size)
 
 void city_festival_schedule(void)
 {
+    replay_record_command(REPLAY_COMMAND_FESTIVAL, city_data.festival.selected.god, city_data.festival.selected.size);
     city_data.festival.planned.god = city_data.festival.selected.god;
     city_data.festival.planned.size = city_data.festival.selected.size;
     int cost;
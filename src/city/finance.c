@@ -5,6 +5,7 @@
 #include "city/data_private.h"
 #include "core/calc.h"
 #include "game/difficulty.h"
+#include "game/replay.h"
 #include "game/time.h"
 
 #define MAX_HOUSE_LEVELS 20
@@ -26,6 +27,7 @@ int city_finance_tax_percentage(void)
 
 void city_finance_change_tax_percentage(int change)
 {
+    replay_record_command(REPLAY_COMMAND_TAX, change);
     city_data.finance.tax_percentage = calc_bound(city_data.finance.tax_percentage + change, 0, 25);
 }
 
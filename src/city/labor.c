@@ -7,6 +7,7 @@
 #include "city/population.h"
 #include "core/calc.h"
 #include "core/random.h"
+#include "game/replay.h"
 #include "game/time.h"
 #include "scenario/property.h"
 
@@ -87,6 +88,7 @@ int city_labor_wages(void)
 
 void city_labor_change_wages(int amount)
 {
+    replay_record_command(REPLAY_COMMAND_WAGES, amount);
     city_data.labor.wages += amount;
     city_data.labor.wages = calc_bound(city_data.labor.wages, 0, 100);
 }
@@ -456,6 +458,7 @@ void city_labor_update(void)
 
 void city_labor_set_priority(int category, int new_priority)
 {
+    replay_record_command(REPLAY_COMMAND_LABOR_PRIORITY, category, new_priority);
     int old_priority = city_data.labor.categories[category].priority;
     if (old_priority == new_priority) {
         return;
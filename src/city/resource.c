@@ -6,6 +6,7 @@
 #include "city/data_private.h"
 #include "core/calc.h"
 #include "empire/city.h"
+#include "game/replay.h"
 #include "game/tutorial.h"
 #include "map/road_access.h"
 #include "scenario/building.h"
@@ -83,6 +84,7 @@ resource_trade_status city_resource_trade_status(resource_type resource)
 
 void city_resource_cycle_trade_status(resource_type resource)
 {
+    replay_record_command(REPLAY_COMMAND_TRADE_STATUS, resource);
     ++city_data.resource.trade_status[resource];
     if (city_data.resource.trade_status[resource] > TRADE_STATUS_EXPORT) {
         city_data.resource.trade_status[resource] = TRADE_STATUS_NONE;
@@ -108,6 +110,7 @@ int city_resource_export_over(resource_type resource)
 
 void city_resource_change_export_over(resource_type resource, int change)
 {
+    replay_record_command(REPLAY_COMMAND_EXPORT_OVER, resource, change);
     city_data.resource.export_over[resource] = calc_bound(city_data.resource.export_over[resource] + change, 0, 100);
 }
 
@@ -118,6 +121,7 @@ int city_resource_is_stockpiled(resource_type resource)
 
 void city_resource_toggle_stockpiled(resource_type resource)
 {
+    replay_record_command(REPLAY_COMMAND_STOCKPILE, resource);
     if (city_data.resource.stockpiled[resource]) {
         city_data.resource.stockpiled[resource] = 0;
     } else {
@@ -135,6 +139,7 @@ int city_resource_is_mothballed(resource_type resource)
 
 void city_resource_toggle_mothballed(resource_type resource)
 {
+    replay_record_command(REPLAY_COMMAND_MOTHBALL, resource);
     city_data.resource.mothballed[resource] = city_data.resource.mothballed[resource] ? 0 : 1;
 }
 
@@ -14,8 +14,12 @@ static const char *INI_FILENAME = "julius.ini";
 static const char *ini_keys[] = {
     "gameplay_fix_immigration",
     "gameplay_fix_100y_ghosts",
+    "gameplay_compact_saves",
     "screen_display_scale",
     "screen_cursor_scale",
+    "screen_image_cache_size",
+    "screen_decode_images_on_demand",
+    "sound_software_mixer",
     "ui_sidebar_info",
     "ui_show_intro_video",
     "ui_smooth_scrolling",
@@ -29,6 +33,7 @@ static const char *ini_keys[] = {
     "ui_highlight_legions",
     "ui_show_military_sidebar",
     "ui_show_speedrun_info",
+    "ui_overlay_heatmap",
 };
 
 static const char *ini_string_keys[] = {
@@ -40,7 +45,8 @@ static char string_values[CONFIG_STRING_MAX_ENTRIES][CONFIG_STRING_VALUE_MAX];
 
 static int default_values[CONFIG_MAX_ENTRIES] = {
     [CONFIG_SCREEN_DISPLAY_SCALE] = 100,
-    [CONFIG_SCREEN_CURSOR_SCALE] = 100
+    [CONFIG_SCREEN_CURSOR_SCALE] = 100,
+    [CONFIG_SCREEN_IMAGE_CACHE_SIZE] = 32
 };
 static const char default_string_values[CONFIG_STRING_MAX_ENTRIES][CONFIG_STRING_VALUE_MAX];
 
@@ -6,8 +6,12 @@
 typedef enum {
     CONFIG_GP_FIX_IMMIGRATION_BUG,
     CONFIG_GP_FIX_100_YEAR_GHOSTS,
+    CONFIG_GP_COMPACT_SAVES,
     CONFIG_SCREEN_DISPLAY_SCALE,
     CONFIG_SCREEN_CURSOR_SCALE,
+    CONFIG_SCREEN_IMAGE_CACHE_SIZE,
+    CONFIG_SCREEN_DECODE_IMAGES_ON_DEMAND,
+    CONFIG_SOUND_SOFTWARE_MIXER,
     CONFIG_UI_SIDEBAR_INFO,
     CONFIG_UI_SHOW_INTRO_VIDEO,
     CONFIG_UI_SMOOTH_SCROLLING,
@@ -21,6 +25,7 @@ typedef enum {
     CONFIG_UI_HIGHLIGHT_LEGIONS,
     CONFIG_UI_SHOW_MILITARY_SIDEBAR,
     CONFIG_UI_SHOW_SPEEDRUN_INFO,
+    CONFIG_UI_OVERLAY_HEATMAP,
     CONFIG_MAX_ENTRIES
 } config_key;
 
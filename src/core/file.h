@@ -77,4 +77,36 @@ int file_exists(const char *filename, int localizable);
  */
 int file_remove(const char *filename);
 
+/**
+ * Rename a file, replacing the destination if it exists
+ * @param filename Filename to rename
+ * @param new_filename New filename
+ * @return boolean true if the file was renamed, false otherwise
+ */
+int file_rename(const char *filename, const char *new_filename);
+
+/**
+ * Maps a file into memory for reading
+ * @param filename File to map
+ * @param size Output: size of the file in bytes
+ * @return Read-only contents of the file, or 0 if the file cannot be mapped on this platform
+ */
+const void *file_map(const char *filename, int *size);
+
+/**
+ * Unmaps a file mapped with file_map()
+ * @param data Contents returned by file_map()
+ * @param size Size returned by file_map()
+ */
+void file_unmap(const void *data, int size);
+
+/**
+ * Gets the size and the last modification time of a file without reading it
+ * @param filename File to check
+ * @param size Output: size of the file in bytes
+ * @param modified Output: last modification time, only meaningful for comparisons
+ * @return boolean true if the information is available, false otherwise
+ */
+int file_get_info(const char *filename, int *size, int64_t *modified);
+
 #endif // CORE_FILE_H
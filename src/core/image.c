@@ -1,10 +1,15 @@
 #include "image.h"
 
 #include "core/buffer.h"
+#include "core/config.h"
+#include "core/dir.h"
 #include "core/file.h"
 #include "core/io.h"
 #include "core/log.h"
+#include "core/parallel.h"
+#include "core/thread.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -39,6 +44,16 @@
 
 #define NAME_SIZE 32
 
+#define MAX_PREFETCH_IMAGES 32
+
+#define ARENA_PAGE_PIXELS (256 * 1024)
+
+#define IMAGES_PER_JOB 100
+#define CHARS_PER_JOB 500
+
+#define CONVERTED_CACHE_VERSION 3
+#define CONVERTED_CACHE_EXTENSION ".cache"
+
 enum {
     NO_EXTRA_FONT = 0,
     FULL_CHARSET_IN_FONT = 1,
@@ -127,6 +142,7 @@ static struct {
     int is_editor;
     int fonts_enabled;
     int font_base_offset;
+    int empire_loaded;
 
     uint16_t group_image_ids[300];
     char bitmaps[100][200];
@@ -140,19 +156,106 @@ static struct {
     uint8_t *tmp_data;
 } data = {.current_climate = -1};
 
+typedef struct external_image {
+    int image_id;
+    int size;
+    color_t *pixels;
+    struct external_image *newer;
+    struct external_image *older;
+} external_image;
+
+typedef struct {
+    int image_id;
+    char path[2 * FILE_NAME_MAX];
+} prefetch_request;
+
+// decoded external images, most recently used first, limited by CONFIG_SCREEN_IMAGE_CACHE_SIZE
+static struct {
+    external_image *newest;
+    external_image *oldest;
+    int total_size;
+    int in_use_id;
+    thread_mutex *mutex;
+    thread *prefetch_thread;
+    int prefetch_running;
+    prefetch_request prefetch[MAX_PREFETCH_IMAGES];
+    int num_prefetch;
+} cache = {.in_use_id = -1};
+
+typedef struct arena_page {
+    struct arena_page *next;
+    int size;
+    int used;
+    color_t pixels[];
+} arena_page;
+
+typedef struct {
+    image *images;
+    int num_images;
+    const uint8_t *source;
+    int source_size;
+    int source_is_mapped;
+    int *source_offsets;
+    color_t **pixels;
+    int group_starts[300];
+    int num_groups;
+    arena_page *pages;
+} lazy_images;
+
+// images that are only decoded when they are first drawn, see CONFIG_SCREEN_DECODE_IMAGES_ON_DEMAND
+static struct {
+    int enabled;
+    int warm_up;
+    thread_mutex *mutex;
+    thread *warm_up_thread;
+    int stop_warm_up;
+    lazy_images main;
+    lazy_images enemy;
+} lazy;
+
+static int init_lazy_images(lazy_images *set, image *images, int num_images)
+{
+    set->images = images;
+    set->num_images = num_images;
+    set->source_offsets = (int *) malloc(num_images * sizeof(int));
+    set->pixels = (color_t **) calloc(num_images, sizeof(color_t *));
+    return set->source_offsets && set->pixels;
+}
+
 int image_init(void)
 {
-    data.enemy_data = (color_t *) malloc(ENEMY_DATA_SIZE);
-    data.main_data = (color_t *) malloc(MAIN_DATA_SIZE);
+    // 0 = decode all images when loading, 1 = decode on first use, 2 = also decode in the background
+    int decode_mode = config_get(CONFIG_SCREEN_DECODE_IMAGES_ON_DEMAND);
+    lazy.enabled = decode_mode > 0;
+    lazy.warm_up = decode_mode > 1;
+    if (!lazy.enabled) {
+        data.enemy_data = (color_t *) malloc(ENEMY_DATA_SIZE);
+        data.main_data = (color_t *) malloc(MAIN_DATA_SIZE);
+    }
     data.empire_data = (color_t *) malloc(EMPIRE_DATA_SIZE);
     data.tmp_data = (uint8_t *) malloc(SCRATCH_DATA_SIZE);
-    if (!data.main_data || !data.empire_data || !data.enemy_data || !data.tmp_data) {
+    int allocated = data.empire_data && data.tmp_data;
+    if (lazy.enabled) {
+        allocated = allocated && init_lazy_images(&lazy.main, data.main, MAIN_ENTRIES) &&
+            init_lazy_images(&lazy.enemy, data.enemy, ENEMY_ENTRIES);
+    } else {
+        allocated = allocated && data.main_data && data.enemy_data;
+    }
+    if (!allocated) {
         free(data.main_data);
         free(data.empire_data);
         free(data.enemy_data);
         free(data.tmp_data);
+        free(lazy.main.source_offsets);
+        free(lazy.main.pixels);
+        free(lazy.enemy.source_offsets);
+        free(lazy.enemy.pixels);
         return 0;
     }
+    // without a mutex, images are not prefetched
+    cache.mutex = thread_mutex_create();
+    // without a mutex, images are not decoded in the background
+    lazy.mutex = thread_mutex_create();
     return 1;
 }
 
@@ -225,10 +328,20 @@ static color_t to_32_bit(uint16_t c)
 
 static int convert_uncompressed(buffer *buf, int buf_length, color_t *dst)
 {
-    for (int i = 0; i < buf_length; i += 2) {
-        *dst = to_32_bit(buffer_read_u16(buf));
-        dst++;
+    int num_pixels = (buf_length + 1) / 2;
+    if (buf->index < 0 || buf->index + num_pixels * 2 > buf->size) {
+        for (int i = 0; i < buf_length; i += 2) {
+            *dst = to_32_bit(buffer_read_u16(buf));
+            dst++;
+        }
+        return buf_length / 2;
     }
+    // reading the bytes directly instead of through the buffer lets the compiler vectorize this loop
+    const uint8_t *src = &buf->data[buf->index];
+    for (int i = 0; i < num_pixels; i++) {
+        dst[i] = to_32_bit((uint16_t) (src[2 * i] | (src[2 * i + 1] << 8)));
+    }
+    buffer_skip(buf, num_pixels * 2);
     return buf_length / 2;
 }
 
@@ -256,28 +369,736 @@ static int convert_compressed(buffer *buf, int buf_length, color_t *dst)
     return dst_length;
 }
 
-static void convert_images(image *images, int size, buffer *buf, color_t *dst)
+static int convert_image(buffer *buf, const image *img, int uncompressed_length, color_t *dst)
+{
+    if (img->draw.is_fully_compressed) {
+        return convert_compressed(buf, img->draw.data_length, dst);
+    } else if (img->draw.has_compressed_part) { // isometric tile
+        int length = convert_uncompressed(buf, uncompressed_length, dst);
+        return length + convert_compressed(buf, img->draw.data_length - uncompressed_length, &dst[length]);
+    } else {
+        return convert_uncompressed(buf, img->draw.data_length, dst);
+    }
+}
+
+static int compressed_length(const uint8_t *src, int src_size, int buf_length)
+{
+    int dst_length = 0;
+    int index = 0;
+    while (buf_length > 0) {
+        int control = index < src_size ? src[index] : 0;
+        if (control == 255) {
+            dst_length += 2;
+            buf_length -= 2;
+            index += 2;
+        } else {
+            dst_length += control + 1;
+            buf_length -= control * 2 + 1;
+            index += control * 2 + 1;
+        }
+    }
+    return dst_length;
+}
+
+static int converted_length(const buffer *buf, const image *img, int source_offset)
+{
+    const uint8_t *src = buf->data;
+    int src_size = 0;
+    if (source_offset >= 0 && source_offset < buf->size) {
+        src = &buf->data[source_offset];
+        src_size = buf->size - source_offset;
+    }
+    if (img->draw.is_fully_compressed) {
+        return compressed_length(src, src_size, img->draw.data_length);
+    } else if (img->draw.has_compressed_part) {
+        int uncompressed_bytes = (img->draw.uncompressed_length + 1) / 2 * 2;
+        if (uncompressed_bytes > src_size) {
+            uncompressed_bytes = src_size;
+        }
+        return img->draw.uncompressed_length / 2 + compressed_length(&src[uncompressed_bytes],
+            src_size - uncompressed_bytes, img->draw.data_length - img->draw.uncompressed_length);
+    } else {
+        return img->draw.data_length / 2;
+    }
+}
+
+typedef struct {
+    image *images;
+    int size;
+    const buffer *buf;
+    const int *source_offsets;
+    color_t *dst;
+} conversion_job;
+
+static void convert_image_range(int index, void *job_data)
 {
-    color_t *start_dst = dst;
-    dst++; // make sure img->offset > 0
+    const conversion_job *job = (const conversion_job *) job_data;
+    buffer buf;
+    buffer_init(&buf, job->buf->data, job->buf->size);
+    int end = (index + 1) * IMAGES_PER_JOB < job->size ? (index + 1) * IMAGES_PER_JOB : job->size;
+    for (int i = index * IMAGES_PER_JOB; i < end; i++) {
+        image *img = &job->images[i];
+        if (img->draw.is_external) {
+            continue;
+        }
+        buffer_set(&buf, job->source_offsets[i]);
+        convert_image(&buf, img, img->draw.uncompressed_length, &job->dst[img->draw.offset]);
+        img->draw.uncompressed_length /= 2;
+    }
+}
+
+static int convert_images(image *images, int size, buffer *buf, color_t *dst)
+{
+    static int source_offsets[MAIN_ENTRIES];
+    if (size > MAIN_ENTRIES) {
+        return 0;
+    }
+    // the converted size of each image gives the offset of the next one,
+    // after which all images can be converted independently
+    int dst_offset = 1; // make sure img->offset > 0
     for (int i = 0; i < size; i++) {
         image *img = &images[i];
         if (img->draw.is_external) {
             continue;
         }
-        buffer_set(buf, img->draw.offset);
-        int img_offset = (int) (dst - start_dst);
+        source_offsets[i] = img->draw.offset;
+        img->draw.offset = dst_offset;
+        dst_offset += converted_length(buf, img, source_offsets[i]);
+    }
+    conversion_job job = {images, size, buf, source_offsets, dst};
+    parallel_for((size + IMAGES_PER_JOB - 1) / IMAGES_PER_JOB, convert_image_range, &job);
+    return dst_offset;
+}
+
+static void lock_cache(void)
+{
+    if (cache.mutex) {
+        thread_mutex_lock(cache.mutex);
+    }
+}
+
+static void unlock_cache(void)
+{
+    if (cache.mutex) {
+        thread_mutex_unlock(cache.mutex);
+    }
+}
+
+static void unlink_cached_image(external_image *entry)
+{
+    if (entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        cache.newest = entry->older;
+    }
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache.oldest = entry->newer;
+    }
+}
+
+static void link_newest_cached_image(external_image *entry)
+{
+    entry->newer = 0;
+    entry->older = cache.newest;
+    if (cache.newest) {
+        cache.newest->newer = entry;
+    } else {
+        cache.oldest = entry;
+    }
+    cache.newest = entry;
+}
+
+static external_image *find_cached_image(int image_id)
+{
+    for (external_image *entry = cache.newest; entry; entry = entry->older) {
+        if (entry->image_id == image_id) {
+            unlink_cached_image(entry);
+            link_newest_cached_image(entry);
+            return entry;
+        }
+    }
+    return 0;
+}
+
+static void free_cached_image(external_image *entry)
+{
+    unlink_cached_image(entry);
+    cache.total_size -= entry->size;
+    free(entry->pixels);
+    free(entry);
+}
+
+static void evict_cached_images(void)
+{
+    int max_size = config_get(CONFIG_SCREEN_IMAGE_CACHE_SIZE) * 1024 * 1024;
+    external_image *entry = cache.oldest;
+    while (entry && cache.total_size > max_size) {
+        external_image *newer = entry->newer;
+        // the image returned last by image_data() may still be drawn
+        if (entry->image_id != cache.in_use_id) {
+            free_cached_image(entry);
+        }
+        entry = newer;
+    }
+}
+
+static external_image *add_cached_image(int image_id, color_t *pixels, int size)
+{
+    external_image *entry = find_cached_image(image_id);
+    if (entry) {
+        // loaded by the prefetch thread in the meantime
+        free(pixels);
+        return entry;
+    }
+    entry = (external_image *) malloc(sizeof(external_image));
+    if (!entry) {
+        free(pixels);
+        return 0;
+    }
+    entry->image_id = image_id;
+    entry->size = size;
+    entry->pixels = pixels;
+    link_newest_cached_image(entry);
+    cache.total_size += size;
+    evict_cached_images();
+    return entry;
+}
+
+static const char *external_image_path(const image *img)
+{
+    char filename[FILE_NAME_MAX] = "555/";
+    strcpy(&filename[4], data.bitmaps[img->draw.bitmap_id]);
+    file_change_extension(filename, "555");
+    const char *path = dir_get_file(&filename[4], MAY_BE_LOCALIZED);
+    if (!path) {
+        // try in 555 dir
+        path = dir_get_file(filename, MAY_BE_LOCALIZED);
+    }
+    return path;
+}
+
+// does not touch shared state, so it can run on the prefetch thread
+static color_t *read_external_image(const image *img, const char *path, int *size)
+{
+    uint8_t *input = (uint8_t *) malloc(img->draw.data_length);
+    if (!input) {
+        return 0;
+    }
+    int bytes_read = 0;
+    FILE *fp = file_open(path, "rb");
+    if (fp) {
+        if (fseek(fp, img->draw.offset - 1, SEEK_SET) == 0) {
+            bytes_read = (int) fread(input, 1, img->draw.data_length, fp);
+        }
+        file_close(fp);
+    }
+    // compressed data never decodes to more pixels than it has bytes,
+    // uncompressed data with an odd length still converts its last byte to a pixel
+    int num_pixels = img->draw.is_fully_compressed ? img->draw.data_length : (img->draw.data_length + 1) / 2;
+    color_t *pixels = bytes_read ? (color_t *) malloc(num_pixels * sizeof(color_t)) : 0;
+    if (pixels) {
+        buffer buf;
+        buffer_init(&buf, input, bytes_read);
+        // NB: isometric images are never external
         if (img->draw.is_fully_compressed) {
-            dst += convert_compressed(buf, img->draw.data_length, dst);
-        } else if (img->draw.has_compressed_part) { // isometric tile
-            dst += convert_uncompressed(buf, img->draw.uncompressed_length, dst);
-            dst += convert_compressed(buf, img->draw.data_length - img->draw.uncompressed_length, dst);
+            convert_compressed(&buf, img->draw.data_length, pixels);
         } else {
-            dst += convert_uncompressed(buf, img->draw.data_length, dst);
+            convert_uncompressed(&buf, img->draw.data_length, pixels);
         }
-        img->draw.offset = img_offset;
-        img->draw.uncompressed_length /= 2;
+        *size = num_pixels * sizeof(color_t);
     }
+    free(input);
+    return pixels;
+}
+
+static const color_t *load_external_data(int image_id)
+{
+    lock_cache();
+    external_image *entry = find_cached_image(image_id);
+    if (entry) {
+        cache.in_use_id = image_id;
+        unlock_cache();
+        return entry->pixels;
+    }
+    unlock_cache();
+
+    image *img = &data.main[image_id];
+    const char *path = external_image_path(img);
+    int size = 0;
+    color_t *pixels = path ? read_external_image(img, path, &size) : 0;
+    if (!pixels) {
+        log_error("unable to load external image", data.bitmaps[img->draw.bitmap_id], image_id);
+        return NULL;
+    }
+    lock_cache();
+    cache.in_use_id = image_id;
+    entry = add_cached_image(image_id, pixels, size);
+    unlock_cache();
+    return entry ? entry->pixels : NULL;
+}
+
+static int prefetch_external_images(void *unused)
+{
+    lock_cache();
+    while (cache.num_prefetch > 0) {
+        prefetch_request request = cache.prefetch[0];
+        cache.num_prefetch--;
+        memmove(&cache.prefetch[0], &cache.prefetch[1], cache.num_prefetch * sizeof(prefetch_request));
+        if (find_cached_image(request.image_id)) {
+            continue;
+        }
+        unlock_cache();
+        int size = 0;
+        color_t *pixels = read_external_image(&data.main[request.image_id], request.path, &size);
+        lock_cache();
+        if (pixels) {
+            add_cached_image(request.image_id, pixels, size);
+        }
+    }
+    cache.prefetch_running = 0;
+    unlock_cache();
+    return 0;
+}
+
+static void finish_prefetch(void)
+{
+    lock_cache();
+    cache.num_prefetch = 0;
+    unlock_cache();
+    if (cache.prefetch_thread) {
+        thread_wait(cache.prefetch_thread);
+        cache.prefetch_thread = 0;
+    }
+}
+
+static void clear_external_cache(void)
+{
+    finish_prefetch();
+    while (cache.oldest) {
+        free_cached_image(cache.oldest);
+    }
+    cache.in_use_id = -1;
+}
+
+void image_prefetch_external(const int *image_ids, int num_images)
+{
+    if (!cache.mutex) {
+        return;
+    }
+    lock_cache();
+    for (int i = 0; i < num_images && cache.num_prefetch < MAX_PREFETCH_IMAGES; i++) {
+        int image_id = image_ids[i];
+        if (image_id < 0 || image_id >= MAIN_ENTRIES || !data.main[image_id].draw.is_external ||
+            image_id == image_group(GROUP_EMPIRE_MAP) || find_cached_image(image_id)) {
+            continue;
+        }
+        // file names are resolved here: dir_get_file() is not thread-safe
+        const char *path = external_image_path(&data.main[image_id]);
+        if (path) {
+            prefetch_request *request = &cache.prefetch[cache.num_prefetch++];
+            request->image_id = image_id;
+            strncpy(request->path, path, 2 * FILE_NAME_MAX - 1);
+            request->path[2 * FILE_NAME_MAX - 1] = 0;
+        }
+    }
+    int start_thread = cache.num_prefetch > 0 && !cache.prefetch_running;
+    if (start_thread) {
+        cache.prefetch_running = 1;
+    }
+    unlock_cache();
+    if (!start_thread) {
+        return;
+    }
+    if (cache.prefetch_thread) {
+        thread_wait(cache.prefetch_thread);
+    }
+    cache.prefetch_thread = thread_create(prefetch_external_images, "image prefetch", 0);
+    if (!cache.prefetch_thread) {
+        // no threads: the images are loaded when they are drawn
+        lock_cache();
+        cache.num_prefetch = 0;
+        cache.prefetch_running = 0;
+        unlock_cache();
+    }
+}
+
+typedef struct {
+    char magic[4];
+    int32_t version;
+    uint32_t info_hash;
+    uint32_t source_hash;
+    int32_t image_struct_size;
+    int32_t num_pixels;
+} converted_cache_header;
+
+typedef struct {
+    char path[FILE_NAME_MAX];
+    uint32_t index_hash;
+    uint32_t info_hash;
+} converted_cache_key;
+
+// FNV-1a
+static uint32_t hash_data(uint32_t hash, const uint8_t *bytes, int size)
+{
+    for (int i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// FNV-1a on 64-bit words, folded to 32 bits: hashing the whole 555 file byte by byte is too slow
+static uint32_t hash_file_contents(uint32_t hash, const uint8_t *bytes, int size)
+{
+    uint64_t hash64 = 14695981039346656037ull ^ hash;
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, &bytes[i], sizeof(word));
+        hash64 = (hash64 ^ word) * 1099511628211ull;
+    }
+    for (; i < size; i++) {
+        hash64 = (hash64 ^ bytes[i]) * 1099511628211ull;
+    }
+    return (uint32_t) (hash64 ^ (hash64 >> 32));
+}
+
+static uint32_t hash_source_contents(uint32_t index_hash, const uint8_t *contents, int size)
+{
+    uint32_t hash = hash_data(index_hash, (const uint8_t *) &size, sizeof(size));
+    return hash_file_contents(hash, contents, size);
+}
+
+/**
+ * Calculates the quick cache key from the index and the size and modification time of the 555 file
+ * @return 1 if calculated, 0 if the 555 file cannot be found or checked
+ */
+static int get_converted_cache_key(const uint8_t *index_data, const char *filename_bmp, converted_cache_key *key)
+{
+    const char *path = dir_get_file(filename_bmp, MAY_BE_LOCALIZED);
+    if (!path) {
+        return 0;
+    }
+    snprintf(key->path, FILE_NAME_MAX, "%s", path);
+    int size;
+    int64_t modified;
+    if (!file_get_info(key->path, &size, &modified)) {
+        return 0;
+    }
+    key->index_hash = hash_data(2166136261u, index_data, MAIN_INDEX_SIZE);
+    uint32_t hash = hash_data(key->index_hash, (const uint8_t *) &size, sizeof(size));
+    key->info_hash = hash_data(hash, (const uint8_t *) &modified, sizeof(modified));
+    return 1;
+}
+
+/**
+ * Hashes the full contents of the 555 file, for when its modification time changed
+ * @return 1 if calculated, 0 if the 555 file cannot be mapped
+ */
+static int hash_sources(const converted_cache_key *key, uint32_t *source_hash)
+{
+    int size;
+    const uint8_t *contents = (const uint8_t *) file_map(key->path, &size);
+    if (!contents) {
+        return 0;
+    }
+    *source_hash = hash_source_contents(key->index_hash, contents, size);
+    file_unmap(contents, size);
+    return 1;
+}
+
+static void get_converted_cache_name(char *cache_name, const char *filename_idx)
+{
+    snprintf(cache_name, FILE_NAME_MAX, "%s%s", filename_idx, CONVERTED_CACHE_EXTENSION);
+}
+
+static int converted_cache_size(int num_pixels)
+{
+    return sizeof(converted_cache_header) + sizeof(data.group_image_ids) + sizeof(data.bitmaps) +
+        sizeof(data.main) + num_pixels * sizeof(color_t);
+}
+
+static void update_converted_cache_key(const char *cache_name, const converted_cache_header *header)
+{
+    FILE *fp = file_open(cache_name, "r+b");
+    if (!fp) {
+        return;
+    }
+    if (fwrite(header, 1, sizeof(*header), fp) != sizeof(*header)) {
+        log_info("Unable to update image cache", cache_name, 0);
+    }
+    file_close(fp);
+}
+
+/**
+ * Loads the index and the converted images of a climate from the cache.
+ * The 555 file is only hashed in full when its size or modification time changed.
+ * @return 1 if loaded, 0 if the cache is stale, -1 if the cache cannot be mapped
+ */
+static int load_converted_cache(const char *cache_name, const converted_cache_key *key)
+{
+    int size;
+    const uint8_t *cached = (const uint8_t *) file_map(cache_name, &size);
+    if (!cached) {
+        return -1;
+    }
+    converted_cache_header header;
+    int valid = 0;
+    int update_key = 0;
+    if (size >= (int) sizeof(header)) {
+        memcpy(&header, cached, sizeof(header));
+        valid = memcmp(header.magic, "JIMC", 4) == 0 &&
+            header.version == CONVERTED_CACHE_VERSION &&
+            header.image_struct_size == (int32_t) sizeof(image) &&
+            header.num_pixels > 0 && header.num_pixels <= MAIN_DATA_SIZE / (int) sizeof(color_t) &&
+            size == converted_cache_size(header.num_pixels);
+    }
+    if (valid && header.info_hash != key->info_hash) {
+        // the file was touched: only a change in contents invalidates the cache
+        uint32_t source_hash;
+        valid = hash_sources(key, &source_hash) && header.source_hash == source_hash;
+        update_key = valid;
+    }
+    if (valid) {
+        const uint8_t *src = cached + sizeof(header);
+        memcpy(data.group_image_ids, src, sizeof(data.group_image_ids));
+        src += sizeof(data.group_image_ids);
+        memcpy(data.bitmaps, src, sizeof(data.bitmaps));
+        src += sizeof(data.bitmaps);
+        memcpy(data.main, src, sizeof(data.main));
+        src += sizeof(data.main);
+        memcpy(data.main_data, src, header.num_pixels * sizeof(color_t));
+    }
+    file_unmap(cached, size);
+    if (update_key) {
+        header.info_hash = key->info_hash;
+        update_converted_cache_key(cache_name, &header);
+    }
+    return valid;
+}
+
+static int write_block(FILE *fp, const void *block, size_t size)
+{
+    return fwrite(block, 1, size, fp) == size;
+}
+
+static void save_converted_cache(const char *cache_name, const converted_cache_key *key,
+    uint32_t source_hash, int num_pixels)
+{
+    char tmp_name[FILE_NAME_MAX];
+    snprintf(tmp_name, FILE_NAME_MAX, "%s.tmp", cache_name);
+    FILE *fp = file_open(tmp_name, "wb");
+    if (!fp) {
+        log_info("Unable to write image cache", cache_name, 0);
+        return;
+    }
+    converted_cache_header header = {
+        {'J', 'I', 'M', 'C'}, CONVERTED_CACHE_VERSION, key->info_hash, source_hash, sizeof(image), num_pixels
+    };
+    int ok = write_block(fp, &header, sizeof(header)) &&
+        write_block(fp, data.group_image_ids, sizeof(data.group_image_ids)) &&
+        write_block(fp, data.bitmaps, sizeof(data.bitmaps)) &&
+        write_block(fp, data.main, sizeof(data.main)) &&
+        write_block(fp, data.main_data, num_pixels * sizeof(color_t));
+    ok = file_close(fp) == 0 && ok;
+    // the cache is only replaced when complete, so a crash never leaves a truncated cache behind
+    if (!ok || !file_rename(tmp_name, cache_name)) {
+        log_info("Unable to write image cache", cache_name, 0);
+        file_remove(tmp_name);
+    }
+}
+
+static void lock_lazy(void)
+{
+    if (lazy.mutex) {
+        thread_mutex_lock(lazy.mutex);
+    }
+}
+
+static void unlock_lazy(void)
+{
+    if (lazy.mutex) {
+        thread_mutex_unlock(lazy.mutex);
+    }
+}
+
+static color_t *arena_reserve(lazy_images *set, int max_pixels)
+{
+    arena_page *page = set->pages;
+    if (!page || page->size - page->used < max_pixels) {
+        int size = max_pixels > ARENA_PAGE_PIXELS ? max_pixels : ARENA_PAGE_PIXELS;
+        page = (arena_page *) malloc(sizeof(arena_page) + size * sizeof(color_t));
+        if (!page) {
+            return 0;
+        }
+        page->size = size;
+        page->used = 0;
+        page->next = set->pages;
+        set->pages = page;
+    }
+    return &page->pixels[page->used];
+}
+
+static void free_lazy_images(lazy_images *set)
+{
+    while (set->pages) {
+        arena_page *next = set->pages->next;
+        free(set->pages);
+        set->pages = next;
+    }
+    if (set->source_is_mapped) {
+        file_unmap(set->source, set->source_size);
+    } else {
+        free((void *) set->source);
+    }
+    set->source = 0;
+    set->source_size = 0;
+    set->source_is_mapped = 0;
+    set->num_groups = 0;
+    memset(set->pixels, 0, set->num_images * sizeof(color_t *));
+}
+
+static int compare_group_starts(const void *a, const void *b)
+{
+    return *(const int *) a - *(const int *) b;
+}
+
+static void set_lazy_groups(lazy_images *set, const uint16_t *group_image_ids, int num_groups)
+{
+    set->num_groups = 0;
+    for (int i = 0; i < num_groups; i++) {
+        if (group_image_ids[i] < set->num_images) {
+            set->group_starts[set->num_groups++] = group_image_ids[i];
+        }
+    }
+    qsort(set->group_starts, set->num_groups, sizeof(int), compare_group_starts);
+}
+
+/**
+ * Keeps the 555 file, mapped into memory if possible, to decode the images from when they are needed
+ */
+static int load_lazy_images(lazy_images *set, const char *filename_bmp)
+{
+    free_lazy_images(set);
+    const char *path = dir_get_file(filename_bmp, MAY_BE_LOCALIZED);
+    if (!path) {
+        return 0;
+    }
+    set->source = (const uint8_t *) file_map(path, &set->source_size);
+    set->source_is_mapped = set->source != 0;
+    if (!set->source) {
+        int size = io_read_file_into_buffer(filename_bmp, MAY_BE_LOCALIZED, data.tmp_data, SCRATCH_DATA_SIZE);
+        uint8_t *source = size ? (uint8_t *) malloc(size) : 0;
+        if (!source) {
+            return 0;
+        }
+        memcpy(source, data.tmp_data, size);
+        set->source = source;
+        set->source_size = size;
+    }
+    for (int i = 0; i < set->num_images; i++) {
+        image *img = &set->images[i];
+        if (!img->draw.is_external) {
+            set->source_offsets[i] = img->draw.offset;
+            img->draw.uncompressed_length /= 2;
+        }
+    }
+    return 1;
+}
+
+static void decode_lazy_image(lazy_images *set, int id)
+{
+    const image *img = &set->images[id];
+    int offset = set->source_offsets[id];
+    if (offset < 0 || img->draw.data_length < 0 || img->draw.data_length > set->source_size - offset) {
+        return;
+    }
+    // compressed data never expands to more pixels than it has bytes
+    color_t *dst = arena_reserve(set, img->draw.data_length + 1);
+    if (!dst) {
+        return;
+    }
+    buffer buf;
+    buffer_init(&buf, (uint8_t *) &set->source[offset], img->draw.data_length);
+    set->pages->used += convert_image(&buf, img, img->draw.uncompressed_length * 2, dst);
+    set->pixels[id] = dst;
+}
+
+static void decode_lazy_group(lazy_images *set, int id)
+{
+    // groups have no end marker: a group runs until the start of the next one
+    int first = id;
+    int last = id;
+    if (set->num_groups > 0) {
+        first = 0;
+        last = set->num_images - 1;
+        for (int i = 0; i < set->num_groups; i++) {
+            if (set->group_starts[i] <= id) {
+                first = set->group_starts[i];
+            } else {
+                last = set->group_starts[i] - 1;
+                break;
+            }
+        }
+    }
+    for (int i = first; i <= last; i++) {
+        if (!set->pixels[i] && !set->images[i].draw.is_external) {
+            decode_lazy_image(set, i);
+        }
+    }
+}
+
+static const color_t *lazy_image_data(lazy_images *set, int id)
+{
+    lock_lazy();
+    if (!set->pixels[id]) {
+        decode_lazy_group(set, id);
+    }
+    const color_t *pixels = set->pixels[id];
+    unlock_lazy();
+    return pixels;
+}
+
+static int warm_up_images(void *unused)
+{
+    for (int i = 0; i < lazy.main.num_groups; i++) {
+        lock_lazy();
+        int stop = lazy.stop_warm_up;
+        if (!stop) {
+            decode_lazy_group(&lazy.main, lazy.main.group_starts[i]);
+        }
+        unlock_lazy();
+        if (stop) {
+            break;
+        }
+    }
+    return 0;
+}
+
+static void start_warm_up(void)
+{
+    if (lazy.warm_up && lazy.mutex) {
+        lazy.stop_warm_up = 0;
+        lazy.warm_up_thread = thread_create(warm_up_images, "image warm-up", 0);
+    }
+}
+
+static void finish_warm_up(void)
+{
+    if (lazy.warm_up_thread) {
+        lock_lazy();
+        lazy.stop_warm_up = 1;
+        unlock_lazy();
+        thread_wait(lazy.warm_up_thread);
+        lazy.warm_up_thread = 0;
+    }
+}
+
+void image_stop_background_decoding(void)
+{
+    finish_warm_up();
+    finish_prefetch();
 }
 
 static void load_empire(void)
@@ -290,6 +1111,7 @@ static void load_empire(void)
     buffer buf;
     buffer_init(&buf, data.tmp_data, size);
     convert_uncompressed(&buf, size, data.empire_data);
+    data.empire_loaded = 1;
 }
 
 static void fix_animation_offsets(void)
@@ -305,6 +1127,8 @@ int image_load_climate(int climate_id, int is_editor, int force_reload)
     if (climate_id == data.current_climate && is_editor == data.is_editor && !force_reload) {
         return 1;
     }
+    clear_external_cache();
+    finish_warm_up();
 
     const char *filename_bmp = is_editor ? EDITOR_GRAPHICS_555[climate_id] : MAIN_GRAPHICS_555[climate_id];
     const char *filename_idx = is_editor ? EDITOR_GRAPHICS_SG2[climate_id] : MAIN_GRAPHICS_SG2[climate_id];
@@ -313,22 +1137,47 @@ int image_load_climate(int climate_id, int is_editor, int force_reload)
         return 0;
     }
 
-    buffer buf;
-    buffer_init(&buf, data.tmp_data, HEADER_SIZE);
-    read_header(&buf);
-    buffer_init(&buf, &data.tmp_data[HEADER_SIZE], ENTRY_SIZE * MAIN_ENTRIES);
-    read_index(&buf, data.main, MAIN_ENTRIES);
-
-    int data_size = io_read_file_into_buffer(filename_bmp, MAY_BE_LOCALIZED, data.tmp_data, SCRATCH_DATA_SIZE);
-    if (!data_size) {
-        return 0;
+    char cache_name[FILE_NAME_MAX];
+    converted_cache_key cache_key;
+    int cache_status = -1;
+    int use_cache = !lazy.enabled && get_converted_cache_key(data.tmp_data, filename_bmp, &cache_key);
+    if (use_cache) {
+        get_converted_cache_name(cache_name, filename_idx);
+        cache_status = load_converted_cache(cache_name, &cache_key);
+    }
+    if (cache_status != 1) {
+        buffer buf;
+        buffer_init(&buf, data.tmp_data, HEADER_SIZE);
+        read_header(&buf);
+        buffer_init(&buf, &data.tmp_data[HEADER_SIZE], ENTRY_SIZE * MAIN_ENTRIES);
+        read_index(&buf, data.main, MAIN_ENTRIES);
+
+        if (lazy.enabled) {
+            if (!load_lazy_images(&lazy.main, filename_bmp)) {
+                return 0;
+            }
+            set_lazy_groups(&lazy.main, data.group_image_ids, 300);
+            start_warm_up();
+        } else {
+            int data_size = io_read_file_into_buffer(filename_bmp, MAY_BE_LOCALIZED, data.tmp_data, SCRATCH_DATA_SIZE);
+            if (!data_size) {
+                return 0;
+            }
+            buffer_init(&buf, data.tmp_data, data_size);
+            int num_pixels = convert_images(data.main, MAIN_ENTRIES, &buf, data.main_data);
+            if (use_cache && (cache_status == 0 || !file_exists(cache_name, NOT_LOCALIZED))) {
+                uint32_t source_hash = hash_source_contents(cache_key.index_hash, data.tmp_data, data_size);
+                save_converted_cache(cache_name, &cache_key, source_hash, num_pixels);
+            }
+        }
     }
-    buffer_init(&buf, data.tmp_data, data_size);
-    convert_images(data.main, MAIN_ENTRIES, &buf, data.main_data);
     data.current_climate = climate_id;
     data.is_editor = is_editor;
 
-    load_empire();
+    // the empire map is the same for all climates
+    if (!data.empire_loaded || force_reload) {
+        load_empire();
+    }
     if (!is_editor) {
         fix_animation_offsets();
     }
@@ -383,24 +1232,49 @@ static int load_external_fonts(int base_offset)
     return 1;
 }
 
-static int parse_multibyte_font(
-    int num_chars, buffer *input, color_t *pixels, int pixel_offset,
-    int char_size, int letter_spacing, int index_offset)
+typedef struct {
+    const buffer *input;
+    int input_start;
+    int bytes_per_char;
+    color_t *pixels;
+    int pixel_offset;
+    int num_chars;
+    int char_size;
+    int width;
+    int height;
+    int bytes_per_row;
+    int index_offset;
+} font_job;
+
+static void init_char(const font_job *job, int char_index, buffer *input, color_t **pixels)
+{
+    image *img = &data.font[job->index_offset + char_index];
+    img->width = job->width;
+    img->height = job->height;
+    img->draw.bitmap_id = 0;
+    img->draw.offset = job->pixel_offset + char_index * job->width * job->height;
+    img->draw.uncompressed_length = img->draw.data_length = img->width * img->height;
+    buffer_init(input, job->input->data, job->input->size);
+    buffer_set(input, job->input_start + char_index * job->bytes_per_char);
+    *pixels = &job->pixels[char_index * job->width * job->height];
+}
+
+static void parse_multibyte_chars(int index, void *job_data)
 {
-    for (int i = 0; i < num_chars; i++) {
-        image *img = &data.font[index_offset + i];
-        img->width = char_size + letter_spacing;
-        img->height = char_size;
-        img->draw.bitmap_id = 0;
-        img->draw.offset = pixel_offset;
-        img->draw.uncompressed_length = img->draw.data_length = img->width * img->height;
-        for (int row = 0; row < char_size; row++) {
+    const font_job *job = (const font_job *) job_data;
+    int letter_spacing = job->width - job->char_size;
+    int end = (index + 1) * CHARS_PER_JOB < job->num_chars ? (index + 1) * CHARS_PER_JOB : job->num_chars;
+    for (int i = index * CHARS_PER_JOB; i < end; i++) {
+        buffer input;
+        color_t *pixels;
+        init_char(job, i, &input, &pixels);
+        for (int row = 0; row < job->char_size; row++) {
             uint8_t bits = 0;
-            for (int col = 0; col < char_size; col++) {
+            for (int col = 0; col < job->char_size; col++) {
                 if (col % 2 == 0) {
-                    bits = buffer_read_u8(input);
+                    bits = buffer_read_u8(&input);
                 }
-                if (col < img->width) {
+                if (col < job->width) {
                     uint8_t value = bits & 0xf;
                     if (value == 0) {
                         *pixels = COLOR_SG2_TRANSPARENT;
@@ -409,38 +1283,32 @@ static int parse_multibyte_font(
                         *pixels = color_value << 24;
                     }
                     pixels++;
-                    pixel_offset++;
                 }
                 bits >>= 4;
             }
             for (int s = 0; s < letter_spacing; s++) {
                 *pixels = COLOR_SG2_TRANSPARENT;
                 pixels++;
-                pixel_offset++;
             }
         }
     }
-    return pixel_offset;
 }
 
-static int parse_chinese_font(
-    int num_chars, buffer *input, color_t *pixels, int pixel_offset, int char_size, int index_offset)
+static void parse_bitmap_chars(int index, void *job_data)
 {
-    int bytes_per_row = char_size <= 16 ? 2 : 3;
-    for (int i = 0; i < num_chars; i++) {
-        image *img = &data.font[index_offset + i];
-        img->width = char_size + 1;
-        img->height = char_size - 1;
-        img->draw.bitmap_id = 0;
-        img->draw.offset = pixel_offset;
-        img->draw.uncompressed_length = img->draw.data_length = img->width * img->height;
-        for (int row = 0; row < img->height; row++) {
-            unsigned int bits = buffer_read_u16(input);
-            if (bytes_per_row == 3) {
-                bits += buffer_read_u8(input) << 16;
+    const font_job *job = (const font_job *) job_data;
+    int end = (index + 1) * CHARS_PER_JOB < job->num_chars ? (index + 1) * CHARS_PER_JOB : job->num_chars;
+    for (int i = index * CHARS_PER_JOB; i < end; i++) {
+        buffer input;
+        color_t *pixels;
+        init_char(job, i, &input, &pixels);
+        for (int row = 0; row < job->height; row++) {
+            unsigned int bits = buffer_read_u16(&input);
+            if (job->bytes_per_row == 3) {
+                bits += buffer_read_u8(&input) << 16;
             }
             int prev_set = 0;
-            for (int col = 0; col < img->width; col++) {
+            for (int col = 0; col < job->width; col++) {
                 int set = bits & 1;
                 if (set) {
                     *pixels = ALPHA_OPAQUE;
@@ -450,13 +1318,64 @@ static int parse_chinese_font(
                     *pixels = COLOR_SG2_TRANSPARENT;
                 }
                 pixels++;
-                pixel_offset++;
                 bits >>= 1;
                 prev_set = set;
             }
         }
     }
-    return pixel_offset;
+}
+
+/**
+ * All characters of a font have the same size, so the position of every character
+ * in the file and in the pixel data is known in advance and they can be parsed in parallel
+ */
+static int parse_font(font_job *job, buffer *input, parallel_function *parse_chars)
+{
+    job->input = input;
+    job->input_start = input->index;
+    parallel_for((job->num_chars + CHARS_PER_JOB - 1) / CHARS_PER_JOB, parse_chars, job);
+    buffer_skip(input, job->num_chars * job->bytes_per_char);
+    return job->pixel_offset + job->num_chars * job->width * job->height;
+}
+
+static int parse_multibyte_font(
+    int num_chars, buffer *input, color_t *pixels, int pixel_offset,
+    int char_size, int letter_spacing, int index_offset)
+{
+    font_job job = {0};
+    job.bytes_per_char = char_size * ((char_size + 1) / 2);
+    job.pixels = pixels;
+    job.pixel_offset = pixel_offset;
+    job.num_chars = num_chars;
+    job.char_size = char_size;
+    job.width = char_size + letter_spacing;
+    job.height = char_size;
+    job.index_offset = index_offset;
+    return parse_font(&job, input, parse_multibyte_chars);
+}
+
+static int parse_bitmap_font(
+    int num_chars, buffer *input, color_t *pixels, int pixel_offset,
+    int char_size, int width, int height, int index_offset)
+{
+    font_job job = {0};
+    job.bytes_per_row = char_size <= 16 ? 2 : 3;
+    job.bytes_per_char = height * job.bytes_per_row;
+    job.pixels = pixels;
+    job.pixel_offset = pixel_offset;
+    job.num_chars = num_chars;
+    job.char_size = char_size;
+    job.width = width;
+    job.height = height;
+    job.index_offset = index_offset;
+    return parse_font(&job, input, parse_bitmap_chars);
+}
+
+static int parse_chinese_font(
+    int num_chars, buffer *input, color_t *pixels, int pixel_offset, int char_size, int index_offset)
+{
+    return parse_bitmap_font(num_chars, input, pixels, pixel_offset, char_size, char_size + 1, char_size - 1,
+        index_offset);
 }
 
 static int load_traditional_chinese_fonts(void)
@@ -545,37 +1464,8 @@ static int load_simplified_chinese_fonts(void)
 
 static int parse_korean_font(buffer *input, color_t *pixels, int pixel_offset, int char_size, int index_offset)
 {
-    int bytes_per_row = char_size <= 16 ? 2 : 3;
-    for (int i = 0; i < IMAGE_FONT_MULTIBYTE_KOREAN_MAX_CHARS; i++) {
-        image *img = &data.font[index_offset + i];
-        img->width = char_size;
-        img->height = char_size;
-        img->draw.bitmap_id = 0;
-        img->draw.offset = pixel_offset;
-        img->draw.uncompressed_length = img->draw.data_length = img->width * img->height;
-        for (int row = 0; row < char_size; row++) {
-            unsigned int bits = buffer_read_u16(input);
-            if (bytes_per_row == 3) {
-                bits += buffer_read_u8(input) << 16;
-            }
-            int prev_set = 0;
-            for (int col = 0; col < char_size; col++) {
-                int set = bits & 1;
-                if (set) {
-                    *pixels = ALPHA_OPAQUE;
-                } else if (prev_set) {
-                    *pixels = ALPHA_FONT_SEMI_TRANSPARENT;
-                } else {
-                    *pixels = COLOR_SG2_TRANSPARENT;
-                }
-                pixels++;
-                pixel_offset++;
-                bits >>= 1;
-                prev_set = set;
-            }
-        }
-    }
-    return pixel_offset;
+    return parse_bitmap_font(IMAGE_FONT_MULTIBYTE_KOREAN_MAX_CHARS, input, pixels, pixel_offset,
+        char_size, char_size, char_size, index_offset);
 }
 
 static int load_korean_fonts(void)
@@ -689,6 +1579,12 @@ int image_load_enemy(int enemy_id)
     buffer_init(&buf, data.tmp_data, ENEMY_INDEX_SIZE);
     read_index(&buf, data.enemy, ENEMY_ENTRIES);
 
+    if (lazy.enabled) {
+        lock_lazy();
+        int loaded = load_lazy_images(&lazy.enemy, filename_bmp);
+        unlock_lazy();
+        return loaded;
+    }
     int data_size = io_read_file_into_buffer(filename_bmp, MAY_BE_LOCALIZED, data.tmp_data, SCRATCH_DATA_SIZE);
     if (!data_size) {
         return 0;
@@ -698,40 +1594,6 @@ int image_load_enemy(int enemy_id)
     return 1;
 }
 
-static const color_t *load_external_data(int image_id)
-{
-    image *img = &data.main[image_id];
-    char filename[FILE_NAME_MAX] = "555/";
-    strcpy(&filename[4], data.bitmaps[img->draw.bitmap_id]);
-    file_change_extension(filename, "555");
-    int size = io_read_file_part_into_buffer(
-        &filename[4], MAY_BE_LOCALIZED, data.tmp_data,
-        img->draw.data_length, img->draw.offset - 1
-    );
-    if (!size) {
-        // try in 555 dir
-        size = io_read_file_part_into_buffer(
-            filename, MAY_BE_LOCALIZED, data.tmp_data,
-            img->draw.data_length, img->draw.offset - 1
-        );
-        if (!size) {
-            log_error("unable to load external image",
-                      data.bitmaps[img->draw.bitmap_id], image_id);
-            return NULL;
-        }
-    }
-    buffer buf;
-    buffer_init(&buf, data.tmp_data, size);
-    color_t *dst = (color_t*) &data.tmp_data[4000000];
-    // NB: isometric images are never external
-    if (img->draw.is_fully_compressed) {
-        convert_compressed(&buf, img->draw.data_length, dst);
-    } else {
-        convert_uncompressed(&buf, img->draw.data_length, dst);
-    }
-    return dst;
-}
-
 int image_group(int group)
 {
     return data.group_image_ids[group];
@@ -774,7 +1636,7 @@ const color_t *image_data(int id)
         return NULL;
     }
     if (!data.main[id].draw.is_external) {
-        return &data.main_data[data.main[id].draw.offset];
+        return lazy.enabled ? lazy_image_data(&lazy.main, id) : &data.main_data[data.main[id].draw.offset];
     } else if (id == image_group(GROUP_EMPIRE_MAP)) {
         return data.empire_data;
     } else {
@@ -790,7 +1652,7 @@ const color_t *image_data_letter(int letter_id)
         return &data.font_data[data.font[data.font_base_offset + letter_id - IMAGE_FONT_MULTIBYTE_OFFSET].draw.offset];
     } else if (letter_id < IMAGE_FONT_MULTIBYTE_OFFSET) {
         int image_id = data.group_image_ids[GROUP_FONT] + letter_id;
-        return &data.main_data[data.main[image_id].draw.offset];
+        return lazy.enabled ? lazy_image_data(&lazy.main, image_id) : &data.main_data[data.main[image_id].draw.offset];
     } else {
         return NULL;
     }
@@ -798,6 +1660,9 @@ const color_t *image_data_letter(int letter_id)
 
 const color_t *image_data_enemy(int id)
 {
+    if (lazy.enabled) {
+        return data.enemy[id].draw.is_external ? NULL : lazy_image_data(&lazy.enemy, id);
+    }
     if (data.enemy[id].draw.offset > 0) {
         return &data.enemy_data[data.enemy[id].draw.offset];
     }
@@ -58,6 +58,13 @@ int image_init(void);
  */
 int image_load_climate(int climate_id, int is_editor, int force_reload);
 
+/**
+ * Stops decoding and prefetching images in the background and waits for the background threads to end.
+ * Must be called before forking, so the child process does not inherit a locked image mutex.
+ * Images not yet decoded or loaded are still loaded on first use.
+ */
+void image_stop_background_decoding(void);
+
 /**
  * Loads external fonts file (Cyrillic and Traditional Chinese)
  * @return boolean true on success, false on failure
@@ -106,6 +113,14 @@ const image *image_get_enemy(int id);
  */
 const color_t *image_data(int id);
 
+/**
+ * Starts loading external images on a separate thread, so they are ready when a window draws them.
+ * Images that are not external or already loaded are skipped.
+ * @param image_ids Image IDs to load
+ * @param num_images Number of image IDs
+ */
+void image_prefetch_external(const int *image_ids, int num_images);
+
 /**
  * Gets letter image pixel data by id
  * @param letter_id Letter ID
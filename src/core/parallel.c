@@ -0,0 +1,61 @@
+#include "core/parallel.h"
+
+#include "core/thread.h"
+
+#define MAX_THREADS 16
+
+typedef struct {
+    thread_mutex *mutex;
+    int next_index;
+    int count;
+    parallel_function *func;
+    void *data;
+} parallel_jobs;
+
+static int run_jobs(void *data)
+{
+    parallel_jobs *jobs = (parallel_jobs *) data;
+    while (1) {
+        thread_mutex_lock(jobs->mutex);
+        int index = jobs->next_index++;
+        thread_mutex_unlock(jobs->mutex);
+        if (index >= jobs->count) {
+            break;
+        }
+        jobs->func(index, jobs->data);
+    }
+    return 0;
+}
+
+void parallel_for(int count, parallel_function *func, void *data)
+{
+    int num_threads = thread_cpu_count();
+    if (num_threads > count) {
+        num_threads = count;
+    }
+    if (num_threads > MAX_THREADS) {
+        num_threads = MAX_THREADS;
+    }
+    parallel_jobs jobs = {0, 0, count, func, data};
+    if (num_threads > 1) {
+        jobs.mutex = thread_mutex_create();
+    }
+    if (!jobs.mutex) {
+        for (int i = 0; i < count; i++) {
+            func(i, data);
+        }
+        return;
+    }
+    // the current thread also runs jobs, so one thread less needs to be started
+    thread *threads[MAX_THREADS];
+    for (int i = 1; i < num_threads; i++) {
+        threads[i] = thread_create(run_jobs, "parallel", &jobs);
+    }
+    run_jobs(&jobs);
+    for (int i = 1; i < num_threads; i++) {
+        if (threads[i]) {
+            thread_wait(threads[i]);
+        }
+    }
+    thread_mutex_destroy(jobs.mutex);
+}
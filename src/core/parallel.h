@@ -0,0 +1,26 @@
+#ifndef CORE_PARALLEL_H
+#define CORE_PARALLEL_H
+
+/**
+ * @file
+ * Running independent jobs on all CPU cores.
+ */
+
+/**
+ * Function to run for one job
+ * @param index Index of the job
+ * @param data Data passed to parallel_for()
+ */
+typedef void (parallel_function)(int index, void *data);
+
+/**
+ * Runs func for every index from 0 to count - 1, spread over the available CPU cores.
+ * The calls may run in any order and concurrently, so they must not share state.
+ * When no threads can be started, all calls run on the current thread.
+ * @param count Number of jobs
+ * @param func Function to run for each job
+ * @param data Data to pass to the function
+ */
+void parallel_for(int count, parallel_function *func, void *data);
+
+#endif // CORE_PARALLEL_H
@@ -30,11 +30,15 @@
 // #define BLOCK_VOID 2 - not supported
 #define BLOCK_SOLID 3
 
+#define TREE8_LOOKUP_BITS 8
+#define TREE16_LOOKUP_BITS 12
+
 typedef struct {
     const uint8_t *data;
     int length;
     int index;
-    int bit_index;
+    uint64_t bits;
+    int num_bits;
 } bitstream;
 
 typedef struct huffnode8_t {
@@ -43,9 +47,19 @@ typedef struct huffnode8_t {
     uint8_t value;
 } huffnode8;
 
+/**
+ * Lookup table entry: the node reached after reading `length` bits.
+ * For codes longer than the table, the node is not a leaf and the rest of the code is read bit by bit.
+ */
+typedef struct {
+    const huffnode8 *node;
+    int length;
+} huffentry8;
+
 typedef struct hufftree8_t {
     huffnode8 nodes[512];
     int size;
+    huffentry8 table[1 << TREE8_LOOKUP_BITS];
 } hufftree8;
 
 typedef struct huffnode16_t {
@@ -54,12 +68,18 @@ typedef struct huffnode16_t {
     uint16_t value;
 } huffnode16;
 
+typedef struct {
+    const huffnode16 *node;
+    int length;
+} huffentry16;
+
 typedef struct hufftree16_t {
     huffnode16 *root;
     hufftree8 *low;
     hufftree8 *high;
     uint16_t escape_codes[3];
     huffnode16 *escape_nodes[3];
+    huffentry16 table[1 << TREE16_LOOKUP_BITS];
 } hufftree16;
 
 typedef struct {
@@ -95,18 +115,6 @@ struct smacker_t {
     int32_t current_frame;
 };
 
-static const uint8_t BIT_MASKS[] = {
-    0x00,
-    0x01,
-    0x03,
-    0x07,
-    0x0f,
-    0x1f,
-    0x3f,
-    0x7f,
-    0xff,
-};
-
 static const uint8_t PALETTE_MAP[64] = {
     0x00, 0x04, 0x08, 0x0C, 0x10, 0x14, 0x18, 0x1C,
     0x20, 0x24, 0x28, 0x2C, 0x30, 0x34, 0x38, 0x3C,
@@ -150,39 +158,62 @@ static bitstream *bitstream_init(bitstream *bs, const uint8_t *data, int len)
     bs->data = data;
     bs->length = len;
     bs->index = 0;
-    bs->bit_index = 0;
+    bs->bits = 0;
+    bs->num_bits = 0;
     return bs;
 }
 
-static inline int read_bit(bitstream *bs)
-{
-    if (bs->index >= bs->length) {
-        return 0;
+/**
+ * Fills the bit buffer to at least 57 bits. Bits are read starting at the lowest bit of each byte,
+ * so the next bit to read is always the lowest bit of the buffer. Past the end, zero bits are read.
+ */
+static inline void refill(bitstream *bs)
+{
+    if (bs->index + 8 <= bs->length) {
+        const uint8_t *p = &bs->data[bs->index];
+        uint64_t word = (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) |
+            ((uint64_t) p[3] << 24) | ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) |
+            ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+        int bytes = (63 - bs->num_bits) >> 3;
+        bs->bits |= word << bs->num_bits;
+        bs->index += bytes;
+        bs->num_bits += bytes * 8;
+    } else {
+        while (bs->num_bits <= 56) {
+            if (bs->index < bs->length) {
+                bs->bits |= (uint64_t) bs->data[bs->index] << bs->num_bits;
+            }
+            bs->index++;
+            bs->num_bits += 8;
+        }
     }
-    int result = bs->data[bs->index] & (1 << bs->bit_index);
-    if (++bs->bit_index >= 8) {
-        bs->index++;
-        bs->bit_index = 0;
+}
+
+static inline unsigned int peek_bits(bitstream *bs, int count)
+{
+    if (bs->num_bits < count) {
+        refill(bs);
     }
-    return result ? 1 : 0;
+    return (unsigned int) (bs->bits & ((1u << count) - 1));
+}
+
+static inline void skip_bits(bitstream *bs, int count)
+{
+    bs->bits >>= count;
+    bs->num_bits -= count;
+}
+
+static inline int read_bit(bitstream *bs)
+{
+    int result = peek_bits(bs, 1);
+    skip_bits(bs, 1);
+    return result;
 }
 
 static inline uint8_t read_byte(bitstream *bs)
 {
-    if (bs->bit_index == 0) {
-        // special case: on exact byte boundary
-        if (bs->index < bs->length) {
-            return bs->data[bs->index++];
-        } else {
-            return 0;
-        }
-    }
-    if (bs->index + 1 >= bs->length) {
-        return 0;
-    }
-    uint8_t value = bs->data[bs->index] >> bs->bit_index;
-    bs->index++;
-    value |= (bs->data[bs->index] & BIT_MASKS[bs->bit_index]) << (8 - bs->bit_index);
+    uint8_t value = peek_bits(bs, 8);
+    skip_bits(bs, 8);
     return value;
 }
 
@@ -202,6 +233,19 @@ static huffnode8 *build_tree8_nodes(bitstream *bs, hufftree8 *tree)
     return node;
 }
 
+static void fill_table8(hufftree8 *tree, const huffnode8 *node, unsigned int code, int length)
+{
+    if (node->is_leaf || length == TREE8_LOOKUP_BITS) {
+        for (unsigned int i = code; i < (1 << TREE8_LOOKUP_BITS); i += 1 << length) {
+            tree->table[i].node = node;
+            tree->table[i].length = length;
+        }
+    } else {
+        fill_table8(tree, node->b[0], code, length + 1);
+        fill_table8(tree, node->b[1], code | (1 << length), length + 1);
+    }
+}
+
 static hufftree8 *create_tree8(bitstream *bs)
 {
     if (read_bit(bs)) {
@@ -216,6 +260,7 @@ static hufftree8 *create_tree8(bitstream *bs)
             free(tree);
             return NULL;
         }
+        fill_table8(tree, &tree->nodes[0], 0, 0);
         return tree;
     } else {
         log_info("SMK: WARN: no 8-bit tree found", 0, 0);
@@ -228,9 +273,11 @@ static void free_tree8(hufftree8 *tree)
     free(tree);
 }
 
-static uint8_t lookup_tree8(bitstream *bs, hufftree8 *tree)
+static uint8_t lookup_tree8(bitstream *bs, const hufftree8 *tree)
 {
-    huffnode8 *node = &tree->nodes[0];
+    const huffentry8 *entry = &tree->table[peek_bits(bs, TREE8_LOOKUP_BITS)];
+    skip_bits(bs, entry->length);
+    const huffnode8 *node = entry->node;
     while (!node->is_leaf) {
         node = node->b[read_bit(bs)];
     }
@@ -304,6 +351,20 @@ static huffnode16 *build_tree16_nodes(bitstream *bs, hufftree16 *tree)
     return node;
 }
 
+static void fill_table16(hufftree16 *tree, const huffnode16 *node, unsigned int code, int length)
+{
+    // leaves are stored as nodes, not values, because the values of the escape nodes change while decoding
+    if (node->is_leaf || length == TREE16_LOOKUP_BITS) {
+        for (unsigned int i = code; i < (1 << TREE16_LOOKUP_BITS); i += 1 << length) {
+            tree->table[i].node = node;
+            tree->table[i].length = length;
+        }
+    } else {
+        fill_table16(tree, node->b[0], code, length + 1);
+        fill_table16(tree, node->b[1], code | (1 << length), length + 1);
+    }
+}
+
 static hufftree16 *create_tree16(bitstream *bs, hufftree8 *low, hufftree8 *high)
 {
     hufftree16 *tree = (hufftree16 *) clear_malloc(sizeof(hufftree16));
@@ -336,6 +397,7 @@ static hufftree16 *create_tree16(bitstream *bs, hufftree8 *low, hufftree8 *high)
             tree->escape_nodes[i]->value = 0;
         }
     }
+    fill_table16(tree, tree->root, 0, 0);
     return tree;
 }
 
@@ -353,7 +415,9 @@ static uint16_t lookup_tree16(bitstream *bs, hufftree16 *tree)
     if (!tree) {
         return 0;
     }
-    huffnode16 *node = tree->root;
+    const huffentry16 *entry = &tree->table[peek_bits(bs, TREE16_LOOKUP_BITS)];
+    skip_bits(bs, entry->length);
+    const huffnode16 *node = entry->node;
     while (!node->is_leaf) {
         node = node->b[read_bit(bs)];
     }
@@ -761,34 +825,32 @@ static int decode_video(smacker s, uint8_t *frame_data, int length)
     bitstream *bs = bitstream_init(&bstream, frame_data, length);
 
     uint8_t *video = s->frame_data.video;
+    int width = s->width;
 
     int block_type = 0;
     int chain = 0;
     uint8_t solid_color = 0;
     for (int row = 0; row < s->height; row += 4) {
-        for (int col = 0; col < s->width; col += 4) {
+        for (int col = 0; col < width; col += 4) {
             if (chain <= 0) {
                 uint16_t type = lookup_tree16(bs, s->type_tree);
                 block_type = type & 0x03;
                 chain = CHAIN_SIZE[(type >> 2) & 0x3f];
                 solid_color = type >> 8;
             }
+            uint8_t *pixel = &video[row * width + col];
             if (block_type == BLOCK_MONO) {
                 uint16_t colors = lookup_tree16(bs, s->mclr_tree);
-                uint8_t color1 = colors & 0xff;
-                uint8_t color2 = colors >> 8;
-                uint16_t map = lookup_tree16(bs, s->mmap_tree);
-                for (int y = 0; y < 4; y++) {
-                    uint8_t *pixel = &video[(row + y) * s->width + col];
-                    pixel[0] = (map & 1) ? color2 : color1;
-                    pixel[1] = (map & 2) ? color2 : color1;
-                    pixel[2] = (map & 4) ? color2 : color1;
-                    pixel[3] = (map & 8) ? color2 : color1;
-                    map >>= 4;
+                uint8_t color[2] = { colors & 0xff, colors >> 8 };
+                unsigned int map = lookup_tree16(bs, s->mmap_tree);
+                for (int y = 0; y < 4; y++, pixel += width, map >>= 4) {
+                    pixel[0] = color[map & 1];
+                    pixel[1] = color[(map >> 1) & 1];
+                    pixel[2] = color[(map >> 2) & 1];
+                    pixel[3] = color[(map >> 3) & 1];
                 }
             } else if (block_type == BLOCK_FULL) {
-                for (int y = 0; y < 4; y++) {
-                    uint8_t *pixel = &video[(row + y) * s->width + col];
+                for (int y = 0; y < 4; y++, pixel += width) {
                     uint16_t colors = lookup_tree16(bs, s->full_tree);
                     pixel[2] = colors & 0xff;
                     pixel[3] = colors >> 8;
@@ -797,9 +859,8 @@ static int decode_video(smacker s, uint8_t *frame_data, int length)
                     pixel[1] = colors >> 8;
                 }
             } else if (block_type == BLOCK_SOLID) {
-                for (int y = 0; y < 4; y++) {
-                    uint8_t *pixel = &video[(row + y) * s->width + col];
-                    pixel[0] = pixel[1] = pixel[2] = pixel[3] = solid_color;
+                for (int y = 0; y < 4; y++, pixel += width) {
+                    memset(pixel, solid_color, 4);
                 }
             }
             chain--;
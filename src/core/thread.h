@@ -0,0 +1,70 @@
+#ifndef CORE_THREAD_H
+#define CORE_THREAD_H
+
+/**
+ * @file
+ * Threading primitives, implemented by the underlying system.
+ * Threads are not available on every platform: when thread_create() fails,
+ * the caller should do the work on the current thread instead.
+ */
+
+typedef struct thread thread;
+typedef struct thread_mutex thread_mutex;
+typedef struct thread_condition thread_condition;
+
+typedef int (thread_function)(void *data);
+
+/**
+ * Starts a new thread
+ * @param func Function to run
+ * @param name Name of the thread, for debugging
+ * @param data Data to pass to the function
+ * @return Thread handle, or 0 if the thread could not be created
+ */
+thread *thread_create(thread_function *func, const char *name, void *data);
+
+/**
+ * Waits for a thread to finish and releases it
+ * @param t Thread to wait for
+ * @return Return value of the thread function
+ */
+int thread_wait(thread *t);
+
+/**
+ * Gets the number of logical CPU cores
+ * @return Number of cores, at least 1
+ */
+int thread_cpu_count(void);
+
+/**
+ * Creates a mutex
+ * @return Mutex, or 0 if it could not be created
+ */
+thread_mutex *thread_mutex_create(void);
+
+void thread_mutex_lock(thread_mutex *mutex);
+
+void thread_mutex_unlock(thread_mutex *mutex);
+
+void thread_mutex_destroy(thread_mutex *mutex);
+
+/**
+ * Creates a condition variable
+ * @return Condition, or 0 if it could not be created
+ */
+thread_condition *thread_condition_create(void);
+
+/**
+ * Waits until the condition is signalled. The mutex must be locked by the caller.
+ * @param condition Condition to wait for
+ * @param mutex Locked mutex, which is released while waiting
+ */
+void thread_condition_wait(thread_condition *condition, thread_mutex *mutex);
+
+void thread_condition_signal(thread_condition *condition);
+
+void thread_condition_broadcast(thread_condition *condition);
+
+void thread_condition_destroy(thread_condition *condition);
+
+#endif // CORE_THREAD_H
@@ -16,6 +16,10 @@ enum {
     PK_EOF = 773,
 };
 
+#define PK_HASH_SIZE 4096
+#define PK_NO_POSITION 0xffff
+#define PK_MAX_COPY_LENGTH 516
+
 struct pk_token {
     int stop;
 
@@ -45,32 +49,30 @@ struct pk_comp_buffer {
     uint8_t output_data[2050];
     int output_ptr;
 
+    zip_level level;
+    int max_chain_length;
+    int nice_length;
+
+    // ZIP_LEVEL_BEST: all input positions sorted by hash
     uint16_t analyze_offset_table[2304];
     uint16_t analyze_index[8708];
     signed short long_matcher[518];
 
+    // other levels: chains of input positions with the same hash, most recent first
+    int next_hash_index;
+    uint16_t hash_head[PK_HASH_SIZE];
+    uint16_t hash_prev[8708];
+
     uint16_t codeword_values[774];
     uint8_t codeword_bits[774];
 };
 
-struct pk_decomp_buffer {
-    pk_input_func *input_func;
-    pk_output_func *output_func;
-    struct pk_token *token;
-
-    int window_size;
-    int dictionary_size;
-    uint16_t current_input_byte;
-    int current_input_bits_available;
-
-    int input_buffer_ptr;
-    int input_buffer_end;
-    int output_buffer_ptr;
-    uint8_t input_buffer[2048];
-    uint8_t output_buffer[8708]; // 2x 4096 (max dict size) + 516 for copying
-
-    uint8_t copy_offset_jump_table[256];
-    uint8_t copy_length_jump_table[256];
+struct pk_bit_reader {
+    const uint8_t *data;
+    int length;
+    int ptr;
+    uint64_t bits;
+    int num_bits;
 };
 
 struct pk_copy_length_offset {
@@ -342,11 +344,73 @@ static void pk_implode_determine_copy(struct pk_comp_buffer *buf, int input_inde
     // never reached
 }
 
+static int pk_implode_hash(const uint8_t *data)
+{
+    return ((data[0] << 4) ^ data[1]) & (PK_HASH_SIZE - 1);
+}
+
+static void pk_implode_update_hash_chains(struct pk_comp_buffer *buf, int end_index)
+{
+    for (int index = buf->next_hash_index; index < end_index; index++) {
+        int hash = pk_implode_hash(&buf->input_data[index]);
+        buf->hash_prev[index] = buf->hash_head[hash];
+        buf->hash_head[hash] = (uint16_t) index;
+    }
+    if (end_index > buf->next_hash_index) {
+        buf->next_hash_index = end_index;
+    }
+}
+
+static void pk_implode_determine_copy_from_hash_chain(
+    struct pk_comp_buffer *buf, int input_index, struct pk_copy_length_offset *copy)
+{
+    // like the original algorithm, the previous byte is never used as start of a copy
+    pk_implode_update_hash_chains(buf, input_index - 1);
+
+    const uint8_t *input_ptr = &buf->input_data[input_index];
+    int min_match_index = input_index - buf->dictionary_size + 1;
+    int max_length = (int) sizeof(buf->input_data) - input_index;
+    if (max_length > PK_MAX_COPY_LENGTH) {
+        max_length = PK_MAX_COPY_LENGTH;
+    }
+    int best_length = 1;
+    int chain_length = buf->max_chain_length;
+    int match_index = buf->hash_head[pk_implode_hash(input_ptr)];
+    while (match_index != PK_NO_POSITION && match_index >= min_match_index && chain_length-- > 0) {
+        const uint8_t *match_ptr = &buf->input_data[match_index];
+        if (match_ptr[best_length] == input_ptr[best_length] &&
+            match_ptr[0] == input_ptr[0] && match_ptr[1] == input_ptr[1]) {
+            int length = 2;
+            while (length < max_length && match_ptr[length] == input_ptr[length]) {
+                length++;
+            }
+            if (length > best_length) {
+                best_length = length;
+                copy->offset = (uint16_t) (input_index - match_index - 1);
+                if (length >= buf->nice_length || length >= max_length) {
+                    break;
+                }
+            }
+        }
+        match_index = buf->hash_prev[match_index];
+    }
+    copy->length = best_length < 2 ? 0 : best_length;
+}
+
+static void pk_implode_find_copy(struct pk_comp_buffer *buf, int input_index, struct pk_copy_length_offset *copy)
+{
+    if (buf->level == ZIP_LEVEL_BEST) {
+        pk_implode_determine_copy(buf, input_index, copy);
+    } else {
+        pk_implode_determine_copy_from_hash_chain(buf, input_index, copy);
+    }
+}
+
 static int pk_implode_next_copy_is_better(
     struct pk_comp_buffer *buf, int offset, const struct pk_copy_length_offset *current_copy)
 {
     struct pk_copy_length_offset next_copy;
-    pk_implode_determine_copy(buf, offset + 1, &next_copy);
+    pk_implode_find_copy(buf, offset + 1, &next_copy);
     if (current_copy->length >= next_copy.length) {
         return 0;
     }
@@ -376,6 +440,16 @@ static void pk_implode_analyze_input(struct pk_comp_buffer *buf, int input_start
     }
 }
 
+static void pk_implode_prepare_input(struct pk_comp_buffer *buf, int input_start, int input_end)
+{
+    if (buf->level == ZIP_LEVEL_BEST) {
+        pk_implode_analyze_input(buf, input_start, input_end);
+    } else {
+        memset(buf->hash_head, 0xff, sizeof(buf->hash_head));
+        buf->next_hash_index = input_start;
+    }
+}
+
 static void pk_implode_data(struct pk_comp_buffer *buf)
 {
     int eof = 0;
@@ -404,23 +478,23 @@ static void pk_implode_data(struct pk_comp_buffer *buf)
         }
 
         if (has_leftover_data == 0) {
-            pk_implode_analyze_input(buf, input_ptr, input_end + 1);
+            pk_implode_prepare_input(buf, input_ptr, input_end + 1);
             has_leftover_data++;
             if (buf->dictionary_size != 4096) {
                 has_leftover_data++;
             }
         } else if (has_leftover_data == 1) {
-            pk_implode_analyze_input(buf, input_ptr - buf->dictionary_size + 516, input_end + 1);
+            pk_implode_prepare_input(buf, input_ptr - buf->dictionary_size + 516, input_end + 1);
             has_leftover_data++;
         } else if (has_leftover_data == 2) {
-            pk_implode_analyze_input(buf, input_ptr - buf->dictionary_size, input_end + 1);
+            pk_implode_prepare_input(buf, input_ptr - buf->dictionary_size, input_end + 1);
         }
 
         while (input_ptr < input_end) {
             int write_literal = 0;
             int write_copy = 0;
             struct pk_copy_length_offset copy;
-            pk_implode_determine_copy(buf, input_ptr, &copy);
+            pk_implode_find_copy(buf, input_ptr, &copy);
 
             if (copy.length == 0) {
                 write_literal = 1;
@@ -467,12 +541,20 @@ static void pk_implode_data(struct pk_comp_buffer *buf)
 }
 
 static int pk_implode(pk_input_func *input_func, pk_output_func *output_func,
-                      struct pk_comp_buffer *buf, struct pk_token *token, int dictionary_size)
+                      struct pk_comp_buffer *buf, struct pk_token *token, int dictionary_size, zip_level level)
 {
     buf->input_func = input_func;
     buf->output_func = output_func;
     buf->dictionary_size = dictionary_size;
     buf->token = token;
+    buf->level = level;
+    if (level == ZIP_LEVEL_FAST) {
+        buf->max_chain_length = 8;
+        buf->nice_length = 32;
+    } else {
+        buf->max_chain_length = 128;
+        buf->nice_length = 258;
+    }
     if (dictionary_size == 1024) {
         buf->window_size = 4;
         buf->copy_offset_extra_mask = 0xf;
@@ -521,165 +603,124 @@ static void pk_explode_construct_jump_table(int size, const uint8_t *bits, const
     }
 }
 
-static int pk_explode_set_bits_used(struct pk_decomp_buffer *buf, int num_bits)
+static void pk_explode_fill_bits(struct pk_bit_reader *reader)
 {
-    if (buf->current_input_bits_available >= num_bits) {
-        buf->current_input_bits_available -= num_bits;
-        buf->current_input_byte = (uint16_t) (buf->current_input_byte >> num_bits);
-        return 0;
-    }
-    buf->current_input_byte = (uint16_t) (buf->current_input_byte >> buf->current_input_bits_available);
-    if (buf->input_buffer_ptr == buf->input_buffer_end) {
-        // Fill buffer
-        buf->input_buffer_ptr = 2048;
-        buf->input_buffer_end = buf->input_func(buf->input_buffer, buf->input_buffer_ptr, buf->token);
-        if (!buf->input_buffer_end) {
-            return 1;
-        }
-        buf->input_buffer_ptr = 0;
-    }
-
-    buf->current_input_byte |= (uint16_t) (buf->input_buffer[buf->input_buffer_ptr++] << 8);
-    buf->current_input_byte = (uint16_t) (buf->current_input_byte >> (num_bits - buf->current_input_bits_available));
-    buf->current_input_bits_available += 8 - num_bits;
-    return 0;
-}
-
-static int pk_explode_decode_next_token(struct pk_decomp_buffer *buf)
-{
-    if (buf->current_input_byte & 1) {
-        // copy
-        if (pk_explode_set_bits_used(buf, 1)) {
-            return PK_ERROR_VALUE;
-        }
-        int index = buf->copy_length_jump_table[buf->current_input_byte & 0xff];
-        if (pk_explode_set_bits_used(buf, pk_copy_length_base_bits[index])) {
-            return PK_ERROR_VALUE;
-        }
-        int extra_bits = pk_copy_length_extra_bits[index];
-        if (extra_bits) {
-            int extra_bits_value = buf->current_input_byte & ((1 << extra_bits) - 1);
-            if (pk_explode_set_bits_used(buf, extra_bits) && index + extra_bits_value != 270) {
-                return PK_ERROR_VALUE;
-            }
-            index = pk_copy_length_base_value[index] + extra_bits_value;
-        }
-        return index + 256;
+    if (reader->ptr + 8 <= reader->length) {
+        // read a whole 64-bit little-endian word, only the bytes that fit are counted as read
+        const uint8_t *d = &reader->data[reader->ptr];
+        uint64_t word = (uint64_t) d[0] | ((uint64_t) d[1] << 8) | ((uint64_t) d[2] << 16) |
+            ((uint64_t) d[3] << 24) | ((uint64_t) d[4] << 32) | ((uint64_t) d[5] << 40) |
+            ((uint64_t) d[6] << 48) | ((uint64_t) d[7] << 56);
+        reader->bits |= word << reader->num_bits;
+        int bytes = (63 - reader->num_bits) >> 3;
+        reader->ptr += bytes;
+        reader->num_bits += bytes * 8;
     } else {
-        // literal token
-        if (pk_explode_set_bits_used(buf, 1)) {
-            return PK_ERROR_VALUE;
-        }
-        int result = buf->current_input_byte & 0xff;
-        if (pk_explode_set_bits_used(buf, 8)) {
-            return PK_ERROR_VALUE;
+        while (reader->num_bits <= 56 && reader->ptr < reader->length) {
+            reader->bits |= (uint64_t) reader->data[reader->ptr++] << reader->num_bits;
+            reader->num_bits += 8;
         }
-        return result;
     }
 }
 
-static int pk_explode_get_copy_offset(struct pk_decomp_buffer *buf, int copy_length)
+static void pk_explode_use_bits(struct pk_bit_reader *reader, int num_bits)
 {
-    int index = buf->copy_offset_jump_table[buf->current_input_byte & 0xff];
-    if (pk_explode_set_bits_used(buf, pk_copy_offset_bits[index])) {
-        return 0;
-    }
-    int offset;
-    if (copy_length == 2) {
-        offset = (buf->current_input_byte & 3) | (index << 2);
-        if (pk_explode_set_bits_used(buf, 2)) {
-            return 0;
-        }
-    } else {
-        offset = (buf->current_input_byte & buf->dictionary_size) | (index << buf->window_size);
-        if (pk_explode_set_bits_used(buf, buf->window_size)) {
-            return 0;
-        }
-    }
-    return offset + 1;
+    reader->bits >>= num_bits;
+    reader->num_bits -= num_bits;
 }
 
-static int pk_explode_data(struct pk_decomp_buffer *buf)
+static void pk_explode_copy(uint8_t *output, int output_ptr, int offset, int length)
 {
-    int token;
-    buf->output_buffer_ptr = 4096;
-    while (1) {
-        token = pk_explode_decode_next_token(buf);
-        if (token >= PK_ERROR_VALUE - 1) {
-            break;
-        }
-        if (token >= 256) {
-            // copy offset
-            int length = token - 254;
-            int offset = pk_explode_get_copy_offset(buf, length);
-            if (!offset) {
-                token = PK_ERROR_VALUE;
-                break;
-            }
-            uint8_t *src = &buf->output_buffer[buf->output_buffer_ptr - offset];
-            uint8_t *dst = &buf->output_buffer[buf->output_buffer_ptr];
-            buf->output_buffer_ptr += length;
-            do {
-                *dst = *src;
-                src++;
-                dst++;
-            } while (--length > 0);
-        } else {
-            // literal byte
-            buf->output_buffer[buf->output_buffer_ptr++] = (uint8_t) token;
-        }
-        if (buf->output_buffer_ptr >= 8192) {
-            // Flush buffer
-            buf->output_func(&buf->output_buffer[4096], 4096, buf->token);
-            pk_memcpy(buf->output_buffer, &buf->output_buffer[4096], buf->output_buffer_ptr - 4096);
-            buf->output_buffer_ptr -= 4096;
-        }
+    uint8_t *dst = &output[output_ptr];
+    if (offset >= length && output_ptr >= offset) {
+        memcpy(dst, dst - offset, (size_t) length);
+        return;
     }
-    int remaining_bytes = buf->output_buffer_ptr - 4096;
-    if (remaining_bytes > 0) {
-        // Flush buffer if needed
-        buf->output_func(&buf->output_buffer[4096], remaining_bytes, buf->token);
+    for (int i = 0; i < length; i++) {
+        // the dictionary starts out filled with zeroes
+        dst[i] = output_ptr + i >= offset ? dst[i - offset] : 0;
     }
-    return token;
 }
 
-static int pk_explode(pk_input_func *input_func, pk_output_func *output_func,
-                      struct pk_decomp_buffer *buf, struct pk_token *token)
+/**
+ * Decodes the whole input at once, straight into the output.
+ * Every token takes at most 30 bits, so the bit buffer only needs to be filled once per token.
+ */
+static int pk_explode(const uint8_t *input, int input_length, uint8_t *output, int *output_length)
 {
-    buf->input_func = input_func;
-    buf->output_func = output_func;
-    buf->token = token;
-    buf->input_buffer_ptr = 2048;
-    int bytes_read = buf->input_func(buf->input_buffer, buf->input_buffer_ptr, buf->token);
-    buf->input_buffer_end = bytes_read;
-    if (bytes_read <= 4) {
+    if (input_length <= 4) {
         return PK_TOO_FEW_INPUT_BYTES;
     }
-    int has_literal_encoding = buf->input_buffer[0];
-    buf->window_size = buf->input_buffer[1];
-    buf->current_input_byte = buf->input_buffer[2];
-    buf->current_input_bits_available = 0;
-    buf->input_buffer_ptr = 3;
-
-    if (buf->window_size < 4 || buf->window_size > 6) {
+    int has_literal_encoding = input[0];
+    int window_size = input[1];
+    if (window_size < 4 || window_size > 6) {
         return PK_INVALID_WINDOWSIZE;
     }
-
-    buf->dictionary_size = 0xFFFF >> (16 - buf->window_size);
     if (has_literal_encoding) {
         return PK_LITERAL_ENCODING_UNSUPPORTED;
     }
+    int offset_mask = 0xFFFF >> (16 - window_size);
 
-    // Decode data for copying bytes
-    pk_explode_construct_jump_table(16,
-        pk_copy_length_base_bits, pk_copy_length_base_code, buf->copy_length_jump_table);
-    pk_explode_construct_jump_table(64,
-        pk_copy_offset_bits, pk_copy_offset_code, buf->copy_offset_jump_table);
+    uint8_t copy_length_jump_table[256];
+    uint8_t copy_offset_jump_table[256];
+    pk_explode_construct_jump_table(16, pk_copy_length_base_bits, pk_copy_length_base_code, copy_length_jump_table);
+    pk_explode_construct_jump_table(64, pk_copy_offset_bits, pk_copy_offset_code, copy_offset_jump_table);
+
+    struct pk_bit_reader reader = {input, input_length, 2, 0, 0};
+    int output_ptr = 0;
+    int max_output = *output_length;
+    while (1) {
+        pk_explode_fill_bits(&reader);
+        unsigned int bits = (unsigned int) reader.bits;
+        if (!(bits & 1)) {
+            // literal byte
+            if (reader.num_bits < 9) {
+                return PK_ERROR_DECODING;
+            }
+            if (output_ptr >= max_output) {
+                log_error("COMP2 Out of buffer space.", 0, 0);
+                return PK_ERROR_DECODING;
+            }
+            output[output_ptr++] = (uint8_t) (bits >> 1);
+            pk_explode_use_bits(&reader, 9);
+            continue;
+        }
+        // copy: length code and extra bits, then offset code and low offset bits
+        int index = copy_length_jump_table[(bits >> 1) & 0xff];
+        int length_bits = 1 + pk_copy_length_base_bits[index];
+        int extra_bits = pk_copy_length_extra_bits[index];
+        if (reader.num_bits < length_bits + extra_bits) {
+            return PK_ERROR_DECODING;
+        }
+        int length_code = index;
+        if (extra_bits) {
+            length_code = pk_copy_length_base_value[index] + ((bits >> length_bits) & ((1 << extra_bits) - 1));
+        }
+        pk_explode_use_bits(&reader, length_bits + extra_bits);
+        if (length_code + 256 == PK_EOF) {
+            break;
+        }
+        int length = length_code + 2;
+
+        bits = (unsigned int) reader.bits;
+        int offset_index = copy_offset_jump_table[bits & 0xff];
+        int offset_bits = pk_copy_offset_bits[offset_index];
+        int low_bits = length == 2 ? 2 : window_size;
+        int low_mask = length == 2 ? 3 : offset_mask;
+        if (reader.num_bits < offset_bits + low_bits) {
+            return PK_ERROR_DECODING;
+        }
+        int offset = (((bits >> offset_bits) & low_mask) | (offset_index << low_bits)) + 1;
+        pk_explode_use_bits(&reader, offset_bits + low_bits);
 
-    int result = pk_explode_data(buf);
-    if (result != PK_EOF) {
-        return PK_ERROR_DECODING;
+        if (output_ptr + length > max_output) {
+            log_error("COMP2 Out of buffer space.", 0, 0);
+            return PK_ERROR_DECODING;
+        }
+        pk_explode_copy(output, output_ptr, offset, length);
+        output_ptr += length;
     }
+    *output_length = output_ptr;
     return PK_SUCCESS;
 }
 
@@ -722,6 +763,12 @@ static void zip_output_func(uint8_t *buffer, int length, struct pk_token *token)
 
 int zip_compress(const void *input_buffer, int input_length,
                  void *output_buffer, int *output_length)
+{
+    return zip_compress_level(input_buffer, input_length, output_buffer, output_length, ZIP_LEVEL_NORMAL);
+}
+
+int zip_compress_level(const void *input_buffer, int input_length,
+                       void *output_buffer, int *output_length, zip_level level)
 {
     struct pk_token token;
     struct pk_comp_buffer *buf = (struct pk_comp_buffer *) malloc(sizeof(struct pk_comp_buffer));
@@ -738,7 +785,7 @@ int zip_compress(const void *input_buffer, int input_length,
     token.output_length = *output_length;
 
     int ok = 1;
-    int pk_error = pk_implode(zip_input_func, zip_output_func, buf, &token, 4096);
+    int pk_error = pk_implode(zip_input_func, zip_output_func, buf, &token, 4096, level);
     if (pk_error || token.stop) {
         log_error("COMP Error occurred while compressing.", 0, 0);
         ok = 0;
@@ -752,26 +799,10 @@ int zip_compress(const void *input_buffer, int input_length,
 int zip_decompress(const void *input_buffer, int input_length,
                    void *output_buffer, int *output_length)
 {
-    struct pk_token token;
-    struct pk_decomp_buffer *buf = (struct pk_decomp_buffer *) malloc(sizeof(struct pk_decomp_buffer));
-    if (!buf) {
-        return 0;
-    }
-    memset(buf, 0, sizeof(struct pk_decomp_buffer));
-    memset(&token, 0, sizeof(struct pk_token));
-    token.input_data = (const uint8_t *) input_buffer;
-    token.input_length = input_length;
-    token.output_data = (uint8_t *) output_buffer;
-    token.output_length = *output_length;
-
-    int ok = 1;
-    int pk_error = pk_explode(zip_input_func, zip_output_func, buf, &token);
-    if (pk_error || token.stop) {
+    int pk_error = pk_explode((const uint8_t *) input_buffer, input_length, (uint8_t *) output_buffer, output_length);
+    if (pk_error) {
         log_error("COMP Error uncompressing.", 0, 0);
-        ok = 0;
-    } else {
-        *output_length = token.output_ptr;
+        return 0;
     }
-    free(buf);
-    return ok;
+    return 1;
 }
@@ -6,8 +6,14 @@
  * Compression functions.
  */
 
+typedef enum {
+    ZIP_LEVEL_FAST = 0, /**< Short searches for copies: fastest, compresses least */
+    ZIP_LEVEL_NORMAL = 1, /**< Bounded searches for copies: fast with a good compression ratio */
+    ZIP_LEVEL_BEST = 2 /**< Full search as done by the original game: slowest, compresses most */
+} zip_level;
+
 /**
- * Compresses the input buffer.
+ * Compresses the input buffer with the normal compression level.
  * @param input_buffer Input buffer to compress
  * @param input_length Length of input buffer
  * @param output_buffer Output buffer to write the compressed data to
@@ -16,6 +22,18 @@
  */
 int zip_compress(const void *input_buffer, int input_length, void *output_buffer, int *output_length);
 
+/**
+ * Compresses the input buffer. All levels produce data that the original game can read.
+ * @param input_buffer Input buffer to compress
+ * @param input_length Length of input buffer
+ * @param output_buffer Output buffer to write the compressed data to
+ * @param output_length IN: available length of the output buffer, OUT: written bytes
+ * @param level Compression level
+ * @return boolean true on success, false on error
+ */
+int zip_compress_level(const void *input_buffer, int input_length,
+    void *output_buffer, int *output_length, zip_level level);
+
 /**
  * Decompresses the input buffer
  * @param input_buffer Inputbuffer to decompress
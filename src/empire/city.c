@@ -9,6 +9,7 @@
 #include "empire/trade_route.h"
 #include "empire/type.h"
 #include "figuretype/trader.h"
+#include "game/replay.h"
 #include "scenario/map.h"
 
 #include <string.h>
@@ -288,6 +289,7 @@ static int generate_trader(int city_id, empire_city *city)
 
 void empire_city_open_trade(int city_id)
 {
+    replay_record_command(REPLAY_COMMAND_OPEN_TRADE, city_id);
     empire_city *city = &cities[city_id];
     city_finance_process_construction(city->cost_to_open);
     city->is_open = 1;
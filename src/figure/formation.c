@@ -8,6 +8,7 @@
 #include "figure/formation_herd.h"
 #include "figure/formation_legion.h"
 #include "figure/properties.h"
+#include "game/replay.h"
 #include "map/grid.h"
 #include "sound/effect.h"
 
@@ -149,6 +150,7 @@ void formation_set_selected(int formation_id)
 
 void formation_toggle_empire_service(int formation_id)
 {
+    replay_record_command(REPLAY_COMMAND_EMPIRE_SERVICE, formation_id);
     formations[formation_id].empire_service = formations[formation_id].empire_service ? 0 : 1;
 }
 
@@ -7,6 +7,7 @@
 #include "figure/enemy_army.h"
 #include "figure/figure.h"
 #include "figure/route.h"
+#include "game/replay.h"
 #include "map/building.h"
 #include "map/figure.h"
 #include "map/grid.h"
@@ -84,6 +85,7 @@ void formation_legion_update_recruit_status(building *fort)
 
 void formation_legion_change_layout(formation *m, int new_layout)
 {
+    replay_record_command(REPLAY_COMMAND_LEGION_LAYOUT, m->id, new_layout);
     if (new_layout == FORMATION_MOP_UP && m->layout != FORMATION_MOP_UP) {
         m->prev.layout = m->layout;
     }
@@ -110,6 +112,7 @@ static int prepare_to_move(formation *m)
 
 void formation_legion_move_to(formation *m, int x, int y)
 {
+    replay_record_command(REPLAY_COMMAND_LEGION_MOVE, m->id, x, y);
     map_routing_calculate_distances(m->x_home, m->y_home);
     if (map_routing_distance(map_grid_offset(x, y)) <= 0) {
         return; // unable to route there
@@ -143,6 +146,7 @@ void formation_legion_move_to(formation *m, int x, int y)
 
 void formation_legion_return_home(formation *m)
 {
+    replay_record_command(REPLAY_COMMAND_LEGION_RETURN, m->id);
     map_routing_calculate_distances(m->x_home, m->y_home);
     if (map_routing_distance(map_grid_offset(m->x, m->y)) <= 0) {
         return; // unable to route home
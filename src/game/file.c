@@ -31,6 +31,7 @@
 #include "game/animation.h"
 #include "game/difficulty.h"
 #include "game/file_io.h"
+#include "game/replay.h"
 #include "game/settings.h"
 #include "game/state.h"
 #include "game/time.h"
@@ -207,7 +208,7 @@ static void load_empire_data(int is_custom_scenario, int empire_id)
     scenario_distant_battle_set_enemy_travel_months();
 }
 
-static void initialize_saved_game(void)
+static void prepare_saved_game(void)
 {
     load_empire_data(scenario_is_custom(), scenario_empire_id());
 
@@ -220,13 +221,14 @@ static void initialize_saved_game(void)
     map_orientation_update_buildings();
     figure_route_clean();
     map_road_network_update();
-    building_maintenance_check_rome_access();
+}
+
+static void finish_saved_game(void)
+{
     building_granaries_calculate_stocks();
     building_menu_update();
     city_message_init_problem_areas();
 
-    sound_city_init();
-
     building_construction_clear_type();
     game_undo_disable();
     game_state_reset_overlay();
@@ -244,6 +246,14 @@ static void initialize_saved_game(void)
     game_state_unpause();
 }
 
+static void initialize_saved_game(void)
+{
+    prepare_saved_game();
+    building_maintenance_check_rome_access();
+    finish_saved_game();
+    sound_city_init();
+}
+
 static int get_campaign_mission_offset(int mission_id)
 {
     uint8_t offset_data[4];
@@ -290,6 +300,8 @@ static int start_scenario(const uint8_t *scenario_name, const char *scenario_fil
             return 0;
         }
     }
+    // the new game is set up by the same functions as player commands: keep them out of the old recording
+    replay_stop_recording();
     scenario_set_campaign_mission(mission);
     scenario_set_campaign_rank(rank);
 
@@ -305,6 +317,7 @@ static int start_scenario(const uint8_t *scenario_name, const char *scenario_fil
 
     building_menu_update();
     city_message_init_scenario();
+    replay_start_recording();
     return 1;
 }
 
@@ -352,10 +365,25 @@ int game_file_load_saved_game(const char *filename)
     if (!game_file_io_read_saved_game(filename, 0)) {
         return 0;
     }
+    replay_stop_recording();
     initialize_saved_game();
     building_storage_reset_building_ids();
 
     sound_music_update(1);
+    replay_start_recording();
+    return 1;
+}
+
+int game_file_load_saved_game_headless(const char *filename)
+{
+    if (!game_file_io_read_saved_game(filename, 0)) {
+        return 0;
+    }
+    // nothing is played or recorded: leave the sound and the replay alone
+    prepare_saved_game();
+    building_maintenance_check_rome_access();
+    finish_saved_game();
+    building_storage_reset_building_ids();
     return 1;
 }
 
@@ -364,6 +392,54 @@ int game_file_write_saved_game(const char *filename)
     return game_file_io_write_saved_game(filename);
 }
 
+int game_file_read_saved_game_info(const char *filename, savegame_info *info)
+{
+    return game_file_io_read_saved_game_info(filename, info);
+}
+
+int game_file_write_saved_game_in_background(const char *filename)
+{
+    return game_file_io_write_saved_game_in_background(filename);
+}
+
+void game_file_finish_background_save(void)
+{
+    game_file_io_finish_background_save();
+}
+
+void game_file_update_background_save(void)
+{
+    game_file_io_update_background_save();
+}
+
+int game_file_convert_saved_game(const char *filename, const char *new_filename, int compact)
+{
+    return game_file_io_convert_saved_game(filename, new_filename, compact);
+}
+
+game_snapshot *game_file_create_snapshot(void)
+{
+    return game_file_io_create_snapshot();
+}
+
+int game_file_restore_snapshot(const game_snapshot *snapshot)
+{
+    if (!game_file_io_restore_snapshot(snapshot)) {
+        return 0;
+    }
+    // the snapshot was taken from a running game: checking the access to Rome again would change its state
+    prepare_saved_game();
+    finish_saved_game();
+    sound_city_init();
+    building_storage_reset_building_ids();
+    return 1;
+}
+
+void game_file_free_snapshot(game_snapshot *snapshot)
+{
+    game_file_io_free_snapshot(snapshot);
+}
+
 int game_file_delete_saved_game(const char *filename)
 {
     return game_file_io_delete_saved_game(filename);
@@ -1,6 +1,8 @@
 #ifndef GAME_FILE_H
 #define GAME_FILE_H
 
+#include "game/savegame.h"
+
 #include <stdint.h>
 
 /**
@@ -31,6 +33,13 @@ int game_file_load_scenario_data(const char *scenario_file);
  */
 int game_file_load_saved_game(const char *filename);
 
+/**
+ * Load saved game without updating the music, the city sounds or the replay, for batch processing
+ * @param filename File to load
+ * @return Boolean true on success, false on failure
+ */
+int game_file_load_saved_game_headless(const char *filename);
+
 /**
  * Write saved game to disk
  * @param filename File to save to
@@ -38,6 +47,60 @@ int game_file_load_saved_game(const char *filename);
  */
 int game_file_write_saved_game(const char *filename);
 
+/**
+ * Read the summary of a saved game: city, date, ratings and a small map
+ * @param filename Saved game to read the summary from
+ * @param info Summary to fill
+ * @return Boolean true on success, false when the saved game has no summary
+ */
+int game_file_read_saved_game_info(const char *filename, savegame_info *info);
+
+/**
+ * Write saved game to disk in the background: compressing and writing
+ * happen on a separate thread after the state has been copied
+ * @param filename File to save to
+ * @return Boolean true on success, false on failure
+ */
+int game_file_write_saved_game_in_background(const char *filename);
+
+/**
+ * Wait for a saved game that is being written in the background
+ */
+void game_file_finish_background_save(void);
+
+/**
+ * Completes a saved game written in the background once it is written, without waiting for it
+ */
+void game_file_update_background_save(void);
+
+/**
+ * Convert a saved game between the original and the compact format
+ * @param filename Saved game to convert
+ * @param new_filename File to write the converted saved game to
+ * @param compact Boolean true to convert to the compact format, false for the original format
+ * @return Boolean true on success, false on failure
+ */
+int game_file_convert_saved_game(const char *filename, const char *new_filename, int compact);
+
+/**
+ * Store the current game in memory, for example to try something out and return to it later
+ * @return Snapshot on success, 0 on failure. Must be freed with game_file_free_snapshot()
+ */
+game_snapshot *game_file_create_snapshot(void);
+
+/**
+ * Return to the game stored in a snapshot
+ * @param snapshot Snapshot to restore, which can be restored again later
+ * @return Boolean true on success, false on failure
+ */
+int game_file_restore_snapshot(const game_snapshot *snapshot);
+
+/**
+ * Free a snapshot
+ * @param snapshot Snapshot to free
+ */
+void game_file_free_snapshot(game_snapshot *snapshot);
+
 /**
  * Delete saved game
  * @param filename File to delete
@@ -1,6 +1,7 @@
 #include "file_io.h"
 
 #include "building/barracks.h"
+#include "building/building.h"
 #include "building/count.h"
 #include "building/list.h"
 #include "building/storage.h"
@@ -8,10 +9,17 @@
 #include "city/data.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/parallel.h"
 #include "city/message.h"
+#include "city/finance.h"
+#include "city/population.h"
+#include "city/ratings.h"
 #include "city/view.h"
+#include "core/config.h"
 #include "core/dir.h"
 #include "core/random.h"
+#include "core/string.h"
+#include "core/thread.h"
 #include "core/zip.h"
 #include "empire/city.h"
 #include "empire/empire.h"
@@ -27,9 +35,11 @@
 #include "map/aqueduct.h"
 #include "map/bookmark.h"
 #include "map/building.h"
+#include "map/data.h"
 #include "map/desirability.h"
 #include "map/elevation.h"
 #include "map/figure.h"
+#include "map/grid.h"
 #include "map/image.h"
 #include "map/property.h"
 #include "map/random.h"
@@ -41,6 +51,7 @@
 #include "scenario/emperor_change.h"
 #include "scenario/gladiator_revolt.h"
 #include "scenario/invasion.h"
+#include "scenario/property.h"
 #include "scenario/scenario.h"
 #include "sound/city.h"
 
@@ -51,17 +62,57 @@
 #define COMPRESS_BUFFER_SIZE 600000
 #define UNCOMPRESSED 0x80000000
 
-static const int SAVE_GAME_VERSION = 0x66;
+// compact savegames start with "JSAV" instead of the mission number of the original format
+#define COMPACT_SAVE_MAGIC 0x5641534a
+#define COMPACT_SAVE_VERSION 1
+#define COMPACT_HEADER_SIZE 12
+#define COMPACT_PIECE_ENTRY_SIZE 20
+
+// summary of the saved game after the game state, found through the size and magic number at the end of the file
+#define SAVEGAME_INFO_MAGIC 0x464e494a
+#define SAVEGAME_INFO_VERSION 1
+#define SAVEGAME_INFO_SIZE (4 + SAVEGAME_INFO_PLAYER_NAME_LENGTH + SAVEGAME_INFO_SCENARIO_NAME_LENGTH + 9 * 4 + \
+    SAVEGAME_THUMBNAIL_SIZE * SAVEGAME_THUMBNAIL_SIZE)
+
+typedef enum {
+    COMPACT_CODEC_NONE = 0,
+    COMPACT_CODEC_IMPLODE = 1
+} compact_codec;
 
-static char compress_buffer[COMPRESS_BUFFER_SIZE];
+static const int SAVE_GAME_VERSION = 0x66;
 
 static int savegame_version;
 
 typedef struct {
     buffer buf;
     int compressed;
+    uint8_t *data; // owned memory: while loading, buf may point into a memory-mapped file instead
 } file_piece;
 
+typedef struct {
+    FILE *fp;
+    const uint8_t *data; // contents of the memory-mapped file, or 0 when reading through fp
+    int size;
+    int position;
+} file_reader;
+
+typedef struct {
+    const uint8_t *input;
+    uint8_t *data;
+    int buffer_size;
+    int data_size;
+    int live_size;
+    int ok;
+} compressed_piece;
+
+typedef struct {
+    int offset;
+    int size;
+    int live_size;
+    int stored_size;
+    int codec;
+} compact_piece_entry;
+
 typedef struct {
     buffer *graphic_ids;
     buffer *edge;
@@ -173,12 +224,158 @@ static struct {
     savegame_state state;
 } savegame_data = {0};
 
+// snapshots are stored as blocks of the savegame pieces: unchanged blocks are shared between snapshots
+#define SNAPSHOT_BLOCK_SIZE 4096
+
+typedef struct {
+    int references;
+    uint8_t data[SNAPSHOT_BLOCK_SIZE];
+} snapshot_block;
+
+struct game_snapshot {
+    int num_blocks;
+    snapshot_block **blocks; // 0 for blocks that contain only zeros
+};
+
+// snapshot that was last created or restored: new snapshots share its unchanged blocks
+static const game_snapshot *last_snapshot;
+
+// compressed data of the savegame pieces, so the pieces can be (de)compressed at the same time
+static compressed_piece compressed_pieces[100];
+
+static compact_piece_entry compact_pieces[100];
+
+static uint8_t savegame_info_data[SAVEGAME_INFO_SIZE];
+
+static struct {
+    thread *writer;
+    thread_mutex *mutex;
+    int written;
+    int result;
+    FILE *fp;
+    char filename[FILE_NAME_MAX];
+    char temp_filename[FILE_NAME_MAX];
+    int num_pieces;
+    file_piece pieces[100];
+    uint8_t *data;
+    int compact;
+    uint8_t info[SAVEGAME_INFO_SIZE];
+} background_save;
+
 static void init_file_piece(file_piece *piece, int size, int compressed)
 {
     piece->compressed = compressed;
-    void *data = malloc(size);
-    memset(data, 0, size);
-    buffer_init(&piece->buf, data, size);
+    piece->data = (uint8_t *) malloc(size);
+    memset(piece->data, 0, size);
+    buffer_init(&piece->buf, piece->data, size);
+}
+
+static int reader_open(file_reader *reader, const char *filename)
+{
+    reader->position = 0;
+    reader->fp = 0;
+    reader->data = 0;
+    if (!filename) {
+        // the file does not exist
+        return 0;
+    }
+    reader->data = (const uint8_t *) file_map(filename, &reader->size);
+    if (reader->data) {
+        return 1;
+    }
+    reader->fp = file_open(filename, "rb");
+    return reader->fp != 0;
+}
+
+static void reader_close(file_reader *reader)
+{
+    if (reader->data) {
+        file_unmap(reader->data, reader->size);
+        reader->data = 0;
+    } else if (reader->fp) {
+        file_close(reader->fp);
+        reader->fp = 0;
+    }
+}
+
+static int reader_seek(file_reader *reader, int position)
+{
+    if (!reader->data) {
+        return fseek(reader->fp, position, SEEK_SET) == 0;
+    }
+    if (position < 0 || position > reader->size) {
+        return 0;
+    }
+    reader->position = position;
+    return 1;
+}
+
+static int reader_seek_from_end(file_reader *reader, int offset)
+{
+    if (!reader->data) {
+        return fseek(reader->fp, -offset, SEEK_END) == 0;
+    }
+    return reader_seek(reader, reader->size - offset);
+}
+
+/**
+ * Reads data from the file. Memory-mapped files return a pointer into the mapping,
+ * otherwise the data is read into the given buffer.
+ * Like fread, a partial read fills the buffer with what is available.
+ * @return Pointer to the data, or 0 if not enough data is available
+ */
+static const uint8_t *reader_read(file_reader *reader, int length, uint8_t *buffer)
+{
+    if (!reader->data) {
+        return fread(buffer, 1, length, reader->fp) == length ? buffer : 0;
+    }
+    int available = reader->size - reader->position;
+    if (length > available) {
+        memcpy(buffer, &reader->data[reader->position], available);
+        reader->position = reader->size;
+        return 0;
+    }
+    const uint8_t *data = &reader->data[reader->position];
+    reader->position += length;
+    return data;
+}
+
+static int reader_read_int32(file_reader *reader)
+{
+    uint8_t data[4];
+    const uint8_t *value = reader_read(reader, 4, data);
+    if (!value) {
+        return 0;
+    }
+    buffer buf;
+    buffer_init(&buf, (uint8_t *) value, 4);
+    return buffer_read_i32(&buf);
+}
+
+static void set_piece_data(file_piece *piece, const uint8_t *data)
+{
+    if (data != piece->data) {
+        // only read from while loading, see copy_piece_data()
+        buffer_init(&piece->buf, (uint8_t *) data, piece->buf.size);
+    }
+}
+
+static void restore_piece_data(file_piece *pieces, int num_pieces)
+{
+    for (int i = 0; i < num_pieces; i++) {
+        buffer_init(&pieces[i].buf, pieces[i].data, pieces[i].buf.size);
+    }
+}
+
+// saving skips some fields, which keep the values that were loaded: those must stay in the pieces
+static void copy_piece_data(file_piece *pieces, int num_pieces)
+{
+    for (int i = 0; i < num_pieces; i++) {
+        if (pieces[i].buf.data != pieces[i].data) {
+            memcpy(pieces[i].data, pieces[i].buf.data, pieces[i].buf.size);
+        }
+    }
+    restore_piece_data(pieces, num_pieces);
 }
 
 static buffer *create_scenario_piece(int size)
@@ -508,21 +705,25 @@ int game_file_io_read_scenario(const char *filename)
 {
     log_info("Loading scenario", filename, 0);
     init_scenario_data();
-    FILE *fp = file_open(dir_get_file(filename, NOT_LOCALIZED), "rb");
-    if (!fp) {
+    file_reader reader;
+    if (!reader_open(&reader, dir_get_file(filename, NOT_LOCALIZED))) {
         return 0;
     }
     for (int i = 0; i < scenario_data.num_pieces; i++) {
-        size_t read_size = fread(scenario_data.pieces[i].buf.data, 1, scenario_data.pieces[i].buf.size, fp);
-        if (read_size != scenario_data.pieces[i].buf.size) {
+        file_piece *piece = &scenario_data.pieces[i];
+        const uint8_t *data = reader_read(&reader, piece->buf.size, piece->data);
+        if (!data) {
             log_error("Unable to load scenario", filename, 0);
-            file_close(fp);
+            restore_piece_data(scenario_data.pieces, scenario_data.num_pieces);
+            reader_close(&reader);
             return 0;
         }
+        set_piece_data(piece, data);
     }
-    file_close(fp);
 
     scenario_load_from_state(&scenario_data.state);
+    copy_piece_data(scenario_data.pieces, scenario_data.num_pieces);
+    reader_close(&reader);
     return 1;
 }
 
@@ -544,17 +745,6 @@ int game_file_io_write_scenario(const char *filename)
     return 1;
 }
 
-static int read_int32(FILE *fp)
-{
-    uint8_t data[4];
-    if (fread(&data, 1, 4, fp) != 4) {
-        return 0;
-    }
-    buffer buf;
-    buffer_init(&buf, data, 4);
-    return buffer_read_i32(&buf);
-}
-
 static void write_int32(FILE *fp, int value)
 {
     uint8_t data[4];
@@ -564,97 +754,449 @@ static void write_int32(FILE *fp, int value)
     fwrite(&data, 1, 4, fp);
 }
 
-static int read_compressed_chunk(FILE *fp, void *buffer, int bytes_to_read)
+static int reserve_compressed_piece(compressed_piece *piece, int size)
+{
+    if (piece->buffer_size >= size) {
+        return 1;
+    }
+    uint8_t *data = (uint8_t *) realloc(piece->data, size);
+    if (!data) {
+        return 0;
+    }
+    piece->data = data;
+    piece->buffer_size = size;
+    return 1;
+}
+
+static int read_compressed_chunk(file_reader *reader, file_piece *piece, compressed_piece *compressed)
 {
-    if (bytes_to_read > COMPRESS_BUFFER_SIZE) {
+    // the input of the previous load may point into a file that is no longer mapped
+    compressed->data_size = 0;
+    compressed->input = 0;
+    if (piece->buf.size > COMPRESS_BUFFER_SIZE) {
         return 0;
     }
-    int input_size = read_int32(fp);
+    int input_size = reader_read_int32(reader);
     if ((unsigned int) input_size == UNCOMPRESSED) {
-        if (fread(buffer, 1, bytes_to_read, fp) != bytes_to_read) {
+        compressed->data_size = 0;
+        const uint8_t *data = reader_read(reader, piece->buf.size, piece->data);
+        if (!data) {
             return 0;
         }
+        set_piece_data(piece, data);
     } else {
-        if (fread(compress_buffer, 1, input_size, fp) != input_size
-            || !zip_decompress(compress_buffer, input_size, buffer, &bytes_to_read)) {
+        if (input_size <= 0 || input_size > COMPRESS_BUFFER_SIZE || !reserve_compressed_piece(compressed, input_size)) {
             return 0;
         }
+        compressed->input = reader_read(reader, input_size, compressed->data);
+        if (!compressed->input) {
+            return 0;
+        }
+        compressed->data_size = input_size;
     }
     return 1;
 }
 
-static int write_compressed_chunk(FILE *fp, const void *buffer, int bytes_to_write)
+static void decompress_piece(int index, void *data)
 {
-    if (bytes_to_write > COMPRESS_BUFFER_SIZE) {
-        return 0;
+    const file_piece *piece = &((const file_piece *) data)[index];
+    compressed_piece *compressed = &compressed_pieces[index];
+    // pieces that could not be read are not ok and have nothing to decompress
+    if (compressed->ok && piece->compressed && compressed->data_size) {
+        int output_size = piece->buf.size;
+        compressed->ok = zip_decompress(compressed->input, compressed->data_size, piece->buf.data, &output_size);
     }
-    int output_size = COMPRESS_BUFFER_SIZE;
-    if (zip_compress(buffer, bytes_to_write, compress_buffer, &output_size)) {
-        write_int32(fp, output_size);
-        fwrite(compress_buffer, 1, output_size, fp);
+}
+
+static void compress_piece(int index, void *data)
+{
+    const file_piece *piece = &((const file_piece *) data)[index];
+    compressed_piece *compressed = &compressed_pieces[index];
+    if (piece->compressed) {
+        compressed->data_size = compressed->buffer_size;
+        compressed->ok = zip_compress(piece->buf.data, piece->buf.size, compressed->data, &compressed->data_size);
+    }
+}
+
+static void write_compressed_chunk(FILE *fp, const void *buffer, int bytes_to_write, const compressed_piece *compressed)
+{
+    if (compressed->ok) {
+        write_int32(fp, compressed->data_size);
+        fwrite(compressed->data, 1, compressed->data_size, fp);
     } else {
         // unable to compress: write uncompressed
         write_int32(fp, UNCOMPRESSED);
         fwrite(buffer, 1, bytes_to_write, fp);
     }
-    return 1;
 }
 
-static int savegame_read_from_file(FILE *fp)
+static int savegame_read_from_file(file_reader *reader)
 {
+    int last_piece = savegame_data.num_pieces - 1;
     for (int i = 0; i < savegame_data.num_pieces; i++) {
         file_piece *piece = &savegame_data.pieces[i];
         int result = 0;
         if (piece->compressed) {
-            result = read_compressed_chunk(fp, piece->buf.data, piece->buf.size);
+            result = read_compressed_chunk(reader, piece, &compressed_pieces[i]);
         } else {
-            result = fread(piece->buf.data, 1, piece->buf.size, fp) == piece->buf.size;
+            const uint8_t *data = reader_read(reader, piece->buf.size, piece->data);
+            if (data) {
+                set_piece_data(piece, data);
+                result = 1;
+            }
         }
+        compressed_pieces[i].ok = result;
         // The last piece may be smaller than buf.size
-        if (!result && i != (savegame_data.num_pieces - 1)) {
+        if (!result && i != last_piece) {
+            return 0;
+        }
+    }
+    parallel_for(savegame_data.num_pieces, decompress_piece, savegame_data.pieces);
+    for (int i = 0; i < last_piece; i++) {
+        if (!compressed_pieces[i].ok) {
             return 0;
         }
     }
     return 1;
 }
 
-static void savegame_write_to_file(FILE *fp)
+static int savegame_write_pieces(FILE *fp, const file_piece *pieces, int num_pieces)
 {
-    for (int i = 0; i < savegame_data.num_pieces; i++) {
-        file_piece *piece = &savegame_data.pieces[i];
+    for (int i = 0; i < num_pieces; i++) {
+        if (!pieces[i].compressed) {
+            continue;
+        }
+        // the compressed data is at most 9 bits for every byte, plus header and end marker
+        int size = pieces[i].buf.size + pieces[i].buf.size / 8 + 16;
+        if (pieces[i].buf.size > COMPRESS_BUFFER_SIZE || !reserve_compressed_piece(&compressed_pieces[i], size)) {
+            return 0;
+        }
+    }
+    parallel_for(num_pieces, compress_piece, (void *) pieces);
+    for (int i = 0; i < num_pieces; i++) {
+        const file_piece *piece = &pieces[i];
         if (piece->compressed) {
-            write_compressed_chunk(fp, piece->buf.data, piece->buf.size);
+            write_compressed_chunk(fp, piece->buf.data, piece->buf.size, &compressed_pieces[i]);
         } else {
             fwrite(piece->buf.data, 1, piece->buf.size, fp);
         }
     }
+    return 1;
+}
+
+static int live_data_size(const buffer *buf)
+{
+    int size = buf->size;
+    while (size > 0 && buf->data[size - 1] == 0) {
+        size--;
+    }
+    return size;
+}
+
+static void compress_live_data(int index, void *data)
+{
+    const file_piece *piece = &((const file_piece *) data)[index];
+    compressed_piece *compressed = &compressed_pieces[index];
+    compressed->data_size = compressed->buffer_size;
+    compressed->ok = compressed->live_size > 0 && compressed->live_size <= COMPRESS_BUFFER_SIZE &&
+        zip_compress(piece->buf.data, compressed->live_size, compressed->data, &compressed->data_size) &&
+        compressed->data_size < compressed->live_size;
+}
+
+static void decompress_live_data(int index, void *data)
+{
+    const file_piece *piece = &((const file_piece *) data)[index];
+    const compact_piece_entry *entry = &compact_pieces[index];
+    compressed_piece *compressed = &compressed_pieces[index];
+    compressed->ok = 1;
+    if (entry->codec == COMPACT_CODEC_IMPLODE) {
+        int output_size = entry->live_size;
+        compressed->ok = zip_decompress(compressed->input, entry->stored_size, piece->buf.data, &output_size) &&
+            output_size == entry->live_size;
+    }
+    if (entry->live_size < piece->buf.size) {
+        // everything after the live data was zero padding
+        memset(&piece->buf.data[entry->live_size], 0, piece->buf.size - entry->live_size);
+    }
+}
+
+static int read_compact_piece_entry(file_reader *reader, compact_piece_entry *entry, const file_piece *piece)
+{
+    entry->offset = reader_read_int32(reader);
+    entry->size = reader_read_int32(reader);
+    entry->live_size = reader_read_int32(reader);
+    entry->stored_size = reader_read_int32(reader);
+    entry->codec = reader_read_int32(reader);
+    if (entry->size != piece->buf.size || entry->live_size < 0 || entry->live_size > entry->size ||
+        entry->offset < 0 || entry->stored_size < 0) {
+        return 0;
+    }
+    switch (entry->codec) {
+        case COMPACT_CODEC_NONE:
+            return entry->stored_size == entry->live_size;
+        case COMPACT_CODEC_IMPLODE:
+            return entry->stored_size > 0 && entry->stored_size <= COMPRESS_BUFFER_SIZE;
+        default:
+            return 0;
+    }
+}
+
+static int savegame_read_compact_from_file(file_reader *reader, int start)
+{
+    // the magic number has already been read
+    int version = reader_read_int32(reader);
+    if (version != COMPACT_SAVE_VERSION) {
+        log_error("Unsupported compact savegame version", 0, version);
+        return 0;
+    }
+    if (reader_read_int32(reader) != savegame_data.num_pieces) {
+        return 0;
+    }
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        if (!read_compact_piece_entry(reader, &compact_pieces[i], &savegame_data.pieces[i])) {
+            return 0;
+        }
+    }
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        const compact_piece_entry *entry = &compact_pieces[i];
+        if (!entry->stored_size) {
+            continue;
+        }
+        file_piece *piece = &savegame_data.pieces[i];
+        compressed_piece *compressed = &compressed_pieces[i];
+        if (!reader_seek(reader, start + entry->offset)) {
+            return 0;
+        }
+        if (entry->codec == COMPACT_CODEC_IMPLODE) {
+            if (!reserve_compressed_piece(compressed, entry->stored_size)) {
+                return 0;
+            }
+            compressed->input = reader_read(reader, entry->stored_size, compressed->data);
+            if (!compressed->input) {
+                return 0;
+            }
+        } else {
+            const uint8_t *data = reader_read(reader, entry->stored_size, piece->data);
+            if (!data) {
+                return 0;
+            }
+            if (entry->live_size == piece->buf.size) {
+                set_piece_data(piece, data);
+            } else if (data != piece->data) {
+                // the zero padding has to be restored, so the data cannot stay in the mapped file
+                memcpy(piece->data, data, entry->live_size);
+            }
+        }
+    }
+    parallel_for(savegame_data.num_pieces, decompress_live_data, savegame_data.pieces);
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        if (!compressed_pieces[i].ok) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int savegame_write_compact_pieces(FILE *fp, const file_piece *pieces, int num_pieces)
+{
+    for (int i = 0; i < num_pieces; i++) {
+        compressed_piece *compressed = &compressed_pieces[i];
+        compressed->live_size = live_data_size(&pieces[i].buf);
+        int size = compressed->live_size + compressed->live_size / 8 + 16;
+        if (!reserve_compressed_piece(compressed, size)) {
+            return 0;
+        }
+    }
+    parallel_for(num_pieces, compress_live_data, (void *) pieces);
+
+    write_int32(fp, COMPACT_SAVE_MAGIC);
+    write_int32(fp, COMPACT_SAVE_VERSION);
+    write_int32(fp, num_pieces);
+    int offset = COMPACT_HEADER_SIZE + num_pieces * COMPACT_PIECE_ENTRY_SIZE;
+    for (int i = 0; i < num_pieces; i++) {
+        const compressed_piece *compressed = &compressed_pieces[i];
+        int stored_size = compressed->ok ? compressed->data_size : compressed->live_size;
+        write_int32(fp, offset);
+        write_int32(fp, pieces[i].buf.size);
+        write_int32(fp, compressed->live_size);
+        write_int32(fp, stored_size);
+        write_int32(fp, compressed->ok ? COMPACT_CODEC_IMPLODE : COMPACT_CODEC_NONE);
+        offset += stored_size;
+    }
+    for (int i = 0; i < num_pieces; i++) {
+        const compressed_piece *compressed = &compressed_pieces[i];
+        if (compressed->ok) {
+            fwrite(compressed->data, 1, compressed->data_size, fp);
+        } else {
+            fwrite(pieces[i].buf.data, 1, compressed->live_size, fp);
+        }
+    }
+    return 1;
+}
+
+static int savegame_read_pieces(file_reader *reader, int offset)
+{
+    if (!reader_seek(reader, offset)) {
+        return 0;
+    }
+    if (reader_read_int32(reader) == COMPACT_SAVE_MAGIC) {
+        return savegame_read_compact_from_file(reader, offset);
+    }
+    reader_seek(reader, offset);
+    return savegame_read_from_file(reader);
+}
+
+static int savegame_write_to_file(FILE *fp, const file_piece *pieces, int num_pieces, int compact,
+    const uint8_t *info)
+{
+    int result;
+    if (compact) {
+        result = savegame_write_compact_pieces(fp, pieces, num_pieces);
+    } else {
+        result = savegame_write_pieces(fp, pieces, num_pieces);
+    }
+    if (result && info) {
+        fwrite(info, 1, SAVEGAME_INFO_SIZE, fp);
+        write_int32(fp, SAVEGAME_INFO_SIZE);
+        write_int32(fp, SAVEGAME_INFO_MAGIC);
+    }
+    return result;
+}
+
+static uint8_t get_thumbnail_tile(int grid_offset)
+{
+    int terrain = map_terrain_get(grid_offset);
+    if (terrain & TERRAIN_BUILDING) {
+        building *b = building_get(map_building_at(grid_offset));
+        return building_is_house(b->type) ? SAVEGAME_THUMBNAIL_HOUSE : SAVEGAME_THUMBNAIL_BUILDING;
+    } else if (terrain & TERRAIN_ROAD) {
+        return SAVEGAME_THUMBNAIL_ROAD;
+    } else if (terrain & TERRAIN_WALL_OR_GATEHOUSE) {
+        return SAVEGAME_THUMBNAIL_WALL;
+    } else if (terrain & TERRAIN_AQUEDUCT) {
+        return SAVEGAME_THUMBNAIL_AQUEDUCT;
+    } else if (terrain & TERRAIN_WATER) {
+        return SAVEGAME_THUMBNAIL_WATER;
+    } else if (terrain & (TERRAIN_TREE | TERRAIN_SHRUB)) {
+        return SAVEGAME_THUMBNAIL_TREE;
+    } else if (terrain & (TERRAIN_ROCK | TERRAIN_ELEVATION)) {
+        return SAVEGAME_THUMBNAIL_ROCK;
+    } else {
+        return SAVEGAME_THUMBNAIL_LAND;
+    }
+}
+
+static void create_savegame_info(uint8_t *data)
+{
+    uint8_t name[SAVEGAME_INFO_SCENARIO_NAME_LENGTH];
+    buffer buf;
+    buffer_init(&buf, data, SAVEGAME_INFO_SIZE);
+    buffer_write_i32(&buf, SAVEGAME_INFO_VERSION);
+    memset(name, 0, sizeof(name));
+    string_copy(scenario_player_name(), name, SAVEGAME_INFO_PLAYER_NAME_LENGTH);
+    buffer_write_raw(&buf, name, SAVEGAME_INFO_PLAYER_NAME_LENGTH);
+    memset(name, 0, sizeof(name));
+    string_copy(scenario_name(), name, SAVEGAME_INFO_SCENARIO_NAME_LENGTH);
+    buffer_write_raw(&buf, name, SAVEGAME_INFO_SCENARIO_NAME_LENGTH);
+    buffer_write_i32(&buf, scenario_is_custom() ? -1 : scenario_campaign_mission());
+    buffer_write_i32(&buf, game_time_year());
+    buffer_write_i32(&buf, game_time_month());
+    buffer_write_i32(&buf, city_population());
+    buffer_write_i32(&buf, city_finance_treasury());
+    buffer_write_i32(&buf, city_rating_culture());
+    buffer_write_i32(&buf, city_rating_prosperity());
+    buffer_write_i32(&buf, city_rating_peace());
+    buffer_write_i32(&buf, city_rating_favor());
+    for (int y = 0; y < SAVEGAME_THUMBNAIL_SIZE; y++) {
+        int map_y = y * map_data.height / SAVEGAME_THUMBNAIL_SIZE;
+        for (int x = 0; x < SAVEGAME_THUMBNAIL_SIZE; x++) {
+            int map_x = x * map_data.width / SAVEGAME_THUMBNAIL_SIZE;
+            buffer_write_u8(&buf, get_thumbnail_tile(map_grid_offset(map_x, map_y)));
+        }
+    }
+}
+
+static int read_savegame_info_data(file_reader *reader, uint8_t *data)
+{
+    if (!reader_seek_from_end(reader, 8)) {
+        return 0;
+    }
+    int size = reader_read_int32(reader);
+    if (reader_read_int32(reader) != SAVEGAME_INFO_MAGIC || size != SAVEGAME_INFO_SIZE ||
+        !reader_seek_from_end(reader, 8 + size)) {
+        return 0;
+    }
+    const uint8_t *info = reader_read(reader, size, data);
+    if (info && info != data) {
+        memcpy(data, info, size);
+    }
+    return info != 0;
 }
 
 int game_file_io_read_saved_game(const char *filename, int offset)
 {
+    game_file_io_finish_background_save();
     init_savegame_data();
 
     log_info("Loading saved game", filename, 0);
-    FILE *fp = file_open(dir_get_file(filename, NOT_LOCALIZED), "rb");
-    if (!fp) {
+    file_reader reader;
+    if (!reader_open(&reader, dir_get_file(filename, NOT_LOCALIZED))) {
         log_error("Unable to load game", 0, 0);
         return 0;
     }
-    if (offset) {
-        fseek(fp, offset, SEEK_SET);
+    int result = savegame_read_pieces(&reader, offset);
+    if (result) {
+        savegame_load_from_state(&savegame_data.state);
+    } else {
+        log_error("Unable to load game", 0, 0);
+    }
+    copy_piece_data(savegame_data.pieces, savegame_data.num_pieces);
+    reader_close(&reader);
+    return result;
+}
+
+int game_file_io_read_saved_game_info(const char *filename, savegame_info *info)
+{
+    uint8_t data[SAVEGAME_INFO_SIZE];
+    file_reader reader;
+    if (!reader_open(&reader, dir_get_file(filename, NOT_LOCALIZED))) {
+        return 0;
     }
-    int result = savegame_read_from_file(fp);
-    file_close(fp);
+    int result = read_savegame_info_data(&reader, data);
+    reader_close(&reader);
     if (!result) {
-        log_error("Unable to load game", 0, 0);
         return 0;
     }
-    savegame_load_from_state(&savegame_data.state);
+    buffer buf;
+    buffer_init(&buf, data, SAVEGAME_INFO_SIZE);
+    if (buffer_read_i32(&buf) != SAVEGAME_INFO_VERSION) {
+        return 0;
+    }
+    buffer_read_raw(&buf, info->player_name, SAVEGAME_INFO_PLAYER_NAME_LENGTH);
+    info->player_name[SAVEGAME_INFO_PLAYER_NAME_LENGTH - 1] = 0;
+    buffer_read_raw(&buf, info->scenario_name, SAVEGAME_INFO_SCENARIO_NAME_LENGTH);
+    info->scenario_name[SAVEGAME_INFO_SCENARIO_NAME_LENGTH - 1] = 0;
+    info->mission = buffer_read_i32(&buf);
+    info->year = buffer_read_i32(&buf);
+    info->month = buffer_read_i32(&buf);
+    info->population = buffer_read_i32(&buf);
+    info->treasury = buffer_read_i32(&buf);
+    info->culture = buffer_read_i32(&buf);
+    info->prosperity = buffer_read_i32(&buf);
+    info->peace = buffer_read_i32(&buf);
+    info->favor = buffer_read_i32(&buf);
+    buffer_read_raw(&buf, info->thumbnail, SAVEGAME_THUMBNAIL_SIZE * SAVEGAME_THUMBNAIL_SIZE);
+    for (int i = 0; i < SAVEGAME_THUMBNAIL_SIZE * SAVEGAME_THUMBNAIL_SIZE; i++) {
+        if (info->thumbnail[i] >= SAVEGAME_THUMBNAIL_MAX) {
+            info->thumbnail[i] = SAVEGAME_THUMBNAIL_LAND;
+        }
+    }
     return 1;
 }
 
 int game_file_io_write_saved_game(const char *filename)
 {
+    game_file_io_finish_background_save();
     init_savegame_data();
 
     log_info("Saving game", filename, 0);
@@ -666,13 +1208,211 @@ int game_file_io_write_saved_game(const char *filename)
         log_error("Unable to save game", 0, 0);
         return 0;
     }
-    savegame_write_to_file(fp);
+    create_savegame_info(savegame_info_data);
+    int result = savegame_write_to_file(fp, savegame_data.pieces, savegame_data.num_pieces,
+        config_get(CONFIG_GP_COMPACT_SAVES), savegame_info_data);
     file_close(fp);
+    if (!result) {
+        log_error("Unable to save game", 0, 0);
+    }
+    return result;
+}
+
+static int create_background_save_buffers(void)
+{
+    if (background_save.data) {
+        return 1;
+    }
+    int total_size = 0;
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        total_size += savegame_data.pieces[i].buf.size;
+    }
+    background_save.data = (uint8_t *) malloc(total_size);
+    if (!background_save.data) {
+        return 0;
+    }
+    uint8_t *data = background_save.data;
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        file_piece *piece = &background_save.pieces[i];
+        piece->compressed = savegame_data.pieces[i].compressed;
+        piece->data = data;
+        buffer_init(&piece->buf, data, savegame_data.pieces[i].buf.size);
+        data += piece->buf.size;
+    }
+    background_save.num_pieces = savegame_data.num_pieces;
+    return 1;
+}
+
+static int write_background_save(void *unused)
+{
+    int result = savegame_write_to_file(background_save.fp, background_save.pieces, background_save.num_pieces,
+        background_save.compact, background_save.info);
+    file_close(background_save.fp);
+    background_save.fp = 0;
+    if (background_save.mutex) {
+        thread_mutex_lock(background_save.mutex);
+    }
+    background_save.result = result;
+    background_save.written = 1;
+    if (background_save.mutex) {
+        thread_mutex_unlock(background_save.mutex);
+    }
+    return result;
+}
+
+static int complete_background_save(void)
+{
+    // renaming updates the file cache of some platforms, which is not thread safe: done on the main thread.
+    // The file is written under a temporary name first, so a crash never leaves a broken save behind
+    if (!background_save.result || !file_rename(background_save.temp_filename, background_save.filename)) {
+        log_error("Unable to save game", background_save.filename, 0);
+        file_remove(background_save.temp_filename);
+        return 0;
+    }
     return 1;
 }
 
+int game_file_io_write_saved_game_in_background(const char *filename)
+{
+    game_file_io_finish_background_save();
+    init_savegame_data();
+    if (!create_background_save_buffers()) {
+        return game_file_io_write_saved_game(filename);
+    }
+
+    log_info("Saving game", filename, 0);
+    savegame_version = SAVE_GAME_VERSION;
+    savegame_save_to_state(&savegame_data.state);
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        const buffer *buf = &savegame_data.pieces[i].buf;
+        memcpy(background_save.pieces[i].buf.data, buf->data, buf->size);
+    }
+    background_save.compact = config_get(CONFIG_GP_COMPACT_SAVES);
+    create_savegame_info(background_save.info);
+
+    strncpy(background_save.filename, filename, FILE_NAME_MAX - 1);
+    strncpy(background_save.temp_filename, filename, FILE_NAME_MAX - 5);
+    file_change_extension(background_save.temp_filename, "tmp");
+    if (strcmp(background_save.temp_filename, filename) == 0) {
+        file_append_extension(background_save.temp_filename, "tmp");
+    }
+    background_save.fp = file_open(background_save.temp_filename, "wb");
+    if (!background_save.fp) {
+        log_error("Unable to save game", 0, 0);
+        return 0;
+    }
+    background_save.written = 0;
+    background_save.mutex = thread_mutex_create();
+    if (background_save.mutex) {
+        background_save.writer = thread_create(write_background_save, "savegame", 0);
+    }
+    if (!background_save.writer) {
+        if (background_save.mutex) {
+            thread_mutex_destroy(background_save.mutex);
+            background_save.mutex = 0;
+        }
+        write_background_save(0);
+        return complete_background_save();
+    }
+    return 1;
+}
+
+void game_file_io_finish_background_save(void)
+{
+    if (background_save.writer) {
+        thread_wait(background_save.writer);
+        background_save.writer = 0;
+        thread_mutex_destroy(background_save.mutex);
+        background_save.mutex = 0;
+        complete_background_save();
+    }
+}
+
+void game_file_io_update_background_save(void)
+{
+    if (!background_save.writer) {
+        return;
+    }
+    thread_mutex_lock(background_save.mutex);
+    int written = background_save.written;
+    thread_mutex_unlock(background_save.mutex);
+    if (written) {
+        game_file_io_finish_background_save();
+    }
+}
+
+int game_file_io_convert_saved_game(const char *filename, const char *new_filename, int compact)
+{
+    game_file_io_finish_background_save();
+    init_savegame_data();
+
+    log_info("Converting saved game", filename, 0);
+    file_reader reader;
+    if (!reader_open(&reader, filename)) {
+        log_error("Unable to open saved game", filename, 0);
+        return 0;
+    }
+    int result = savegame_read_pieces(&reader, 0);
+    // keep the summary of the original file
+    int has_info = result && read_savegame_info_data(&reader, savegame_info_data);
+    // the output file may be the input file, so nothing can point into the mapped file anymore
+    copy_piece_data(savegame_data.pieces, savegame_data.num_pieces);
+    reader_close(&reader);
+    if (!result) {
+        log_error("Unable to read saved game", filename, 0);
+        return 0;
+    }
+    FILE *fp = file_open(new_filename, "wb");
+    if (!fp) {
+        log_error("Unable to write saved game", new_filename, 0);
+        return 0;
+    }
+    result = savegame_write_to_file(fp, savegame_data.pieces, savegame_data.num_pieces, compact,
+        has_info ? savegame_info_data : 0);
+    file_close(fp);
+    if (!result) {
+        log_error("Unable to write saved game", new_filename, 0);
+    }
+    return result;
+}
+
+uint8_t *game_file_io_read_saved_game_pieces(const char *filename, int *size)
+{
+    game_file_io_finish_background_save();
+    init_savegame_data();
+
+    file_reader reader;
+    if (!reader_open(&reader, filename)) {
+        log_error("Unable to open saved game", filename, 0);
+        return 0;
+    }
+    int result = savegame_read_pieces(&reader, 0);
+    uint8_t *data = 0;
+    if (result) {
+        int total_size = 0;
+        for (int i = 0; i < savegame_data.num_pieces; i++) {
+            total_size += savegame_data.pieces[i].buf.size;
+        }
+        data = (uint8_t *) malloc(total_size);
+        if (data) {
+            int offset = 0;
+            for (int i = 0; i < savegame_data.num_pieces; i++) {
+                memcpy(&data[offset], savegame_data.pieces[i].buf.data, savegame_data.pieces[i].buf.size);
+                offset += savegame_data.pieces[i].buf.size;
+            }
+            *size = total_size;
+        }
+    } else {
+        log_error("Unable to read saved game", filename, 0);
+    }
+    copy_piece_data(savegame_data.pieces, savegame_data.num_pieces);
+    reader_close(&reader);
+    return data;
+}
+
 int game_file_io_delete_saved_game(const char *filename)
 {
+    game_file_io_finish_background_save();
     log_info("Deleting game", filename, 0);
     int result = file_remove(filename);
     if (!result) {
@@ -680,3 +1420,119 @@ int game_file_io_delete_saved_game(const char *filename)
     }
     return result;
 }
+
+static int count_snapshot_blocks(void)
+{
+    int num_blocks = 0;
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        num_blocks += (savegame_data.pieces[i].buf.size + SNAPSHOT_BLOCK_SIZE - 1) / SNAPSHOT_BLOCK_SIZE;
+    }
+    return num_blocks;
+}
+
+static int is_zero_block(const uint8_t *data, int size)
+{
+    for (int i = 0; i < size; i++) {
+        if (data[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static snapshot_block *create_snapshot_block(const uint8_t *data, int size, snapshot_block *previous)
+{
+    if (previous && memcmp(previous->data, data, size) == 0) {
+        previous->references++;
+        return previous;
+    }
+    snapshot_block *block = (snapshot_block *) malloc(sizeof(snapshot_block));
+    if (block) {
+        block->references = 1;
+        memcpy(block->data, data, size);
+    }
+    return block;
+}
+
+static void release_snapshot_block(snapshot_block *block)
+{
+    if (block && --block->references == 0) {
+        free(block);
+    }
+}
+
+game_snapshot *game_file_io_create_snapshot(void)
+{
+    init_savegame_data();
+    savegame_version = SAVE_GAME_VERSION;
+    savegame_save_to_state(&savegame_data.state);
+
+    game_snapshot *snapshot = (game_snapshot *) malloc(sizeof(game_snapshot));
+    if (!snapshot) {
+        return 0;
+    }
+    snapshot->num_blocks = count_snapshot_blocks();
+    snapshot->blocks = (snapshot_block **) calloc(snapshot->num_blocks, sizeof(snapshot_block *));
+    if (!snapshot->blocks) {
+        free(snapshot);
+        return 0;
+    }
+    int index = 0;
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        const buffer *buf = &savegame_data.pieces[i].buf;
+        for (int offset = 0; offset < buf->size; offset += SNAPSHOT_BLOCK_SIZE, index++) {
+            int size = buf->size - offset < SNAPSHOT_BLOCK_SIZE ? buf->size - offset : SNAPSHOT_BLOCK_SIZE;
+            const uint8_t *data = &buf->data[offset];
+            if (is_zero_block(data, size)) {
+                continue;
+            }
+            snapshot_block *previous = last_snapshot ? last_snapshot->blocks[index] : 0;
+            snapshot->blocks[index] = create_snapshot_block(data, size, previous);
+            if (!snapshot->blocks[index]) {
+                game_file_io_free_snapshot(snapshot);
+                return 0;
+            }
+        }
+    }
+    last_snapshot = snapshot;
+    return snapshot;
+}
+
+int game_file_io_restore_snapshot(const game_snapshot *snapshot)
+{
+    init_savegame_data();
+    if (snapshot->num_blocks != count_snapshot_blocks()) {
+        return 0;
+    }
+    int index = 0;
+    for (int i = 0; i < savegame_data.num_pieces; i++) {
+        const buffer *buf = &savegame_data.pieces[i].buf;
+        for (int offset = 0; offset < buf->size; offset += SNAPSHOT_BLOCK_SIZE, index++) {
+            int size = buf->size - offset < SNAPSHOT_BLOCK_SIZE ? buf->size - offset : SNAPSHOT_BLOCK_SIZE;
+            const snapshot_block *block = snapshot->blocks[index];
+            if (block) {
+                memcpy(&buf->data[offset], block->data, size);
+            } else {
+                memset(&buf->data[offset], 0, size);
+            }
+        }
+    }
+    savegame_load_from_state(&savegame_data.state);
+    last_snapshot = snapshot;
+    return 1;
+}
+
+void game_file_io_free_snapshot(game_snapshot *snapshot)
+{
+    if (!snapshot) {
+        return;
+    }
+    if (last_snapshot == snapshot) {
+        last_snapshot = 0;
+    }
+    for (int i = 0; i < snapshot->num_blocks; i++) {
+        release_snapshot_block(snapshot->blocks[i]);
+    }
+    free(snapshot->blocks);
+    free(snapshot);
+}
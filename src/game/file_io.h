@@ -1,6 +1,8 @@
 #ifndef GAME_FILE_IO_H
 #define GAME_FILE_IO_H
 
+#include "game/savegame.h"
+
 int game_file_io_read_scenario(const char *filename);
 
 int game_file_io_write_scenario(const char *filename);
@@ -9,6 +11,75 @@ int game_file_io_read_saved_game(const char *filename, int offset);
 
 int game_file_io_write_saved_game(const char *filename);
 
+/**
+ * Reads the summary stored at the end of a saved game, without reading the game state itself.
+ * Saved games written by older versions and by Caesar 3 do not have a summary.
+ * @param filename Saved game to read
+ * @param info Summary to fill
+ * @return Boolean true if the summary was read, false if the file has no summary
+ */
+int game_file_io_read_saved_game_info(const char *filename, savegame_info *info);
+
+/**
+ * Copies the game state and writes it to file on a separate thread.
+ * The file is written under a temporary name and renamed when complete.
+ * @param filename File to save to
+ * @return Boolean true if the save was started, false on failure
+ */
+int game_file_io_write_saved_game_in_background(const char *filename);
+
+/**
+ * Waits until a save started by game_file_io_write_saved_game_in_background() is written
+ */
+void game_file_io_finish_background_save(void);
+
+/**
+ * Finishes a save started by game_file_io_write_saved_game_in_background() when it has been written,
+ * without waiting for it: the saved game is renamed to its final name on the calling thread
+ */
+void game_file_io_update_background_save(void);
+
+/**
+ * Converts a saved game between the original and the compact format without loading it.
+ * Both formats hold exactly the same game state: the compact format leaves out the zero padding
+ * at the end of every piece and has a piece table at the start for random access.
+ * @param filename Saved game to convert, in either format
+ * @param new_filename File to write the converted saved game to
+ * @param compact Boolean true to write the compact format, false for the original format
+ * @return Boolean true on success, false on failure
+ */
+int game_file_io_convert_saved_game(const char *filename, const char *new_filename, int compact);
+
+/**
+ * Reads the game state of a saved game in either format without loading it, for inspection by tools.
+ * The pieces are decompressed in parallel and returned after each other in file order.
+ * @param filename Saved game to read
+ * @param size Set to the total size of all pieces
+ * @return Buffer with the pieces, to be freed by the caller, or 0 on failure
+ */
+uint8_t *game_file_io_read_saved_game_pieces(const char *filename, int *size);
+
+/**
+ * Stores the complete game state in memory, without compression or disk access.
+ * Parts of the state that did not change since the last created or restored snapshot
+ * are shared with that snapshot, so keeping many snapshots of the same city is cheap.
+ * @return Snapshot, or 0 when out of memory. Must be freed with game_file_io_free_snapshot()
+ */
+game_snapshot *game_file_io_create_snapshot(void);
+
+/**
+ * Replaces the game state with the state stored in the snapshot
+ * @param snapshot Snapshot to restore, it stays valid and can be restored again
+ * @return Boolean true on success, false on failure
+ */
+int game_file_io_restore_snapshot(const game_snapshot *snapshot);
+
+/**
+ * Frees a snapshot. Memory shared with other snapshots is only freed together with the last of them.
+ * @param snapshot Snapshot to free, may be 0
+ */
+void game_file_io_free_snapshot(game_snapshot *snapshot);
+
 int game_file_io_delete_saved_game(const char *filename);
 
 #endif // GAME_FILE_IO_H
@@ -14,11 +14,13 @@
 #include "game/animation.h"
 #include "game/file.h"
 #include "game/file_editor.h"
+#include "game/replay.h"
 #include "game/settings.h"
 #include "game/speed.h"
 #include "game/state.h"
 #include "game/tick.h"
 #include "graphics/font.h"
+#include "graphics/text.h"
 #include "graphics/video.h"
 #include "graphics/window.h"
 #include "scenario/property.h"
@@ -74,7 +76,7 @@ static int is_unpatched(void)
     return difficulty_option == help_menu || delete_game == option_menu;
 }
 
-int game_init(void)
+static int load_game_data(int *missing_fonts)
 {
     if (!image_init()) {
         errlog("unable to init graphics");
@@ -88,11 +90,11 @@ int game_init(void)
         errlog("unable to load enemy graphics");
         return 0;
     }
-    int missing_fonts = 0;
+    *missing_fonts = 0;
     if (!image_load_fonts(encoding_get())) {
         errlog("unable to load font graphics");
         if (encoding_get() == ENCODING_KOREAN || encoding_get() == ENCODING_JAPANESE) {
-            missing_fonts = 1;
+            *missing_fonts = 1;
         } else {
             return 0;
         }
@@ -102,6 +104,15 @@ int game_init(void)
         errlog("unable to load c3_model.txt");
         return 0;
     }
+    return 1;
+}
+
+int game_init(void)
+{
+    int missing_fonts;
+    if (!load_game_data(&missing_fonts)) {
+        return 0;
+    }
 
     sound_system_init();
     game_state_init();
@@ -110,6 +121,16 @@ int game_init(void)
     return 1;
 }
 
+int game_init_headless(void)
+{
+    int missing_fonts;
+    if (!load_game_data(&missing_fonts)) {
+        return 0;
+    }
+    game_state_init();
+    return 1;
+}
+
 static int reload_language(int is_editor, int reload_images)
 {
     if (!lang_load(is_editor)) {
@@ -126,6 +147,7 @@ static int reload_language(int is_editor, int reload_images)
         errlog("unable to load font graphics");
         return 0;
     }
+    text_invalidate_cache();
     if (!image_load_climate(CLIMATE_CENTRAL, is_editor, reload_images)) {
         errlog("unable to load main graphics");
         return 0;
@@ -177,6 +199,7 @@ void game_run(void)
             break;
         }
     }
+    game_file_update_background_save();
 }
 
 void game_draw(void)
@@ -187,6 +210,8 @@ void game_draw(void)
 
 void game_exit(void)
 {
+    game_file_finish_background_save();
+    replay_stop_recording();
     video_shutdown();
     settings_save();
     config_save();
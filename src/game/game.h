@@ -5,6 +5,12 @@ int game_pre_init(void);
 
 int game_init(void);
 
+/**
+ * Initializes the game without sound and without showing any window, for batch processing
+ * @return Boolean true on success, false on failure
+ */
+int game_init_headless(void);
+
 int game_init_editor(void);
 
 int game_reload_language(void);
@@ -3,11 +3,13 @@
 #include "city/view.h"
 #include "city/warning.h"
 #include "core/direction.h"
+#include "game/replay.h"
 #include "map/orientation.h"
 #include "widget/minimap.h"
 
 void game_orientation_rotate_left(void)
 {
+    replay_record_command(REPLAY_COMMAND_ROTATE, 0);
     city_view_rotate_left();
     map_orientation_change(0);
     widget_minimap_invalidate();
@@ -16,6 +18,7 @@ void game_orientation_rotate_left(void)
 
 void game_orientation_rotate_right(void)
 {
+    replay_record_command(REPLAY_COMMAND_ROTATE, 1);
     city_view_rotate_right();
     map_orientation_change(1);
     widget_minimap_invalidate();
@@ -24,6 +27,7 @@ void game_orientation_rotate_right(void)
 
 void game_orientation_rotate_north(void)
 {
+    replay_record_command(REPLAY_COMMAND_ROTATE, 2);
     switch (city_view_orientation()) {
         case DIR_2_RIGHT:
             city_view_rotate_right();
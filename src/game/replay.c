@@ -0,0 +1,386 @@
+#include "replay.h"
+
+#include "building/construction.h"
+#include "building/storage.h"
+#include "city/emperor.h"
+#include "city/festival.h"
+#include "city/finance.h"
+#include "city/labor.h"
+#include "city/resource.h"
+#include "core/buffer.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "core/random.h"
+#include "empire/city.h"
+#include "figure/formation.h"
+#include "figure/formation_legion.h"
+#include "game/file_io.h"
+#include "game/orientation.h"
+#include "game/time.h"
+#include "game/undo.h"
+#include "map/grid.h"
+#include "scenario/request.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_VERSION 2
+#define MAX_PARAMS 6
+#define MAX_LINE_LENGTH 200
+#define MAX_RECORDINGS 999
+
+typedef struct {
+    const char *name;
+    int num_params;
+} command_info;
+
+static const command_info COMMANDS[REPLAY_COMMAND_MAX] = {
+    {"none", 0},
+    {"construct", 6},
+    {"rotate", 1},
+    {"tax", 1},
+    {"wages", 1},
+    {"labor_priority", 2},
+    {"legion_move", 3},
+    {"legion_return", 1},
+    {"legion_layout", 2},
+    {"storage_cycle", 2},
+    {"storage_accept_none", 1},
+    {"storage_empty_all", 1},
+    {"open_trade", 1},
+    {"trade_status", 1},
+    {"export_over", 2},
+    {"stockpile", 1},
+    {"mothball", 1},
+    {"festival", 2},
+    {"undo", 0},
+    {"send_gift", 1},
+    {"donate", 1},
+    {"salary", 1},
+    {"dispatch_request", 1},
+    {"empire_service", 1},
+};
+
+typedef struct {
+    int time;
+    uint32_t random_iv1;
+    uint32_t random_iv2;
+    replay_command_type type;
+    int params[MAX_PARAMS];
+} replay_command;
+
+static struct {
+    char filename[FILE_NAME_MAX];
+    FILE *fp;
+    replay_command *commands;
+    int num_commands;
+    int next_command;
+    int errors;
+} data;
+
+static int current_time(void)
+{
+    return ((game_time_year() * 12 + game_time_month()) * 16 + game_time_day()) * 50 + game_time_tick();
+}
+
+static void get_random_state(uint32_t *iv1, uint32_t *iv2)
+{
+    uint8_t state[8];
+    buffer buf;
+    buffer_init(&buf, state, 8);
+    random_save_state(&buf);
+    buffer_init(&buf, state, 8);
+    *iv1 = buffer_read_u32(&buf);
+    *iv2 = buffer_read_u32(&buf);
+}
+
+void replay_set_recording_file(const char *filename)
+{
+    strncpy(data.filename, filename, FILE_NAME_MAX - 1);
+}
+
+static void get_start_file(const char *replay_file, char *start_file)
+{
+    strncpy(start_file, replay_file, FILE_NAME_MAX - 5);
+    start_file[FILE_NAME_MAX - 5] = 0;
+    file_change_extension(start_file, "sav");
+    if (strcmp(start_file, replay_file) == 0) {
+        file_append_extension(start_file, "sav");
+    }
+}
+
+/**
+ * Finds names for the replay and its start that do not overwrite an earlier recording:
+ * the recording file itself, or the recording file with a number added before the extension
+ */
+static int find_recording_files(char *replay_file, char *start_file)
+{
+    const char *extension = strrchr(data.filename, '.');
+    if (!extension || strchr(extension, '/') || strchr(extension, '\\')) {
+        extension = data.filename + strlen(data.filename);
+    }
+    int base_length = (int) (extension - data.filename);
+    for (int i = 1; i <= MAX_RECORDINGS; i++) {
+        if (i == 1) {
+            snprintf(replay_file, FILE_NAME_MAX, "%s", data.filename);
+        } else {
+            snprintf(replay_file, FILE_NAME_MAX, "%.*s-%d%s", base_length, data.filename, i, extension);
+        }
+        get_start_file(replay_file, start_file);
+        if (!file_exists(replay_file, NOT_LOCALIZED) && !file_exists(start_file, NOT_LOCALIZED)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void replay_start_recording(void)
+{
+    if (!data.filename[0] || data.commands) {
+        return;
+    }
+    replay_stop_recording();
+
+    char replay_file[FILE_NAME_MAX];
+    char start_file[FILE_NAME_MAX];
+    if (!find_recording_files(replay_file, start_file)) {
+        log_error("Too many replays recorded, not recording", data.filename, 0);
+        return;
+    }
+    if (!game_file_io_write_saved_game(start_file)) {
+        log_error("Unable to write start of replay", start_file, 0);
+        return;
+    }
+    data.fp = file_open(replay_file, "w");
+    if (!data.fp) {
+        log_error("Unable to record replay", replay_file, 0);
+        return;
+    }
+    fprintf(data.fp, "julius-replay %d %d\n", REPLAY_VERSION, current_time());
+    fflush(data.fp);
+    log_info("Recording replay", replay_file, 0);
+}
+
+void replay_stop_recording(void)
+{
+    if (data.fp) {
+        fprintf(data.fp, "%d end\n", current_time());
+        file_close(data.fp);
+        data.fp = 0;
+    }
+}
+
+void replay_record_command(replay_command_type type, ...)
+{
+    if (!data.fp || type <= REPLAY_COMMAND_NONE || type >= REPLAY_COMMAND_MAX) {
+        return;
+    }
+    uint32_t iv1, iv2;
+    get_random_state(&iv1, &iv2);
+    fprintf(data.fp, "%d %08x:%08x %s", current_time(), (unsigned int) iv1, (unsigned int) iv2, COMMANDS[type].name);
+    va_list args;
+    va_start(args, type);
+    for (int i = 0; i < COMMANDS[type].num_params; i++) {
+        fprintf(data.fp, " %d", va_arg(args, int));
+    }
+    va_end(args);
+    fprintf(data.fp, "\n");
+    // the replay is most useful when the game crashes: do not keep the command in a buffer
+    fflush(data.fp);
+}
+
+static replay_command_type get_command_type(const char *name)
+{
+    for (int i = REPLAY_COMMAND_NONE + 1; i < REPLAY_COMMAND_MAX; i++) {
+        if (strcmp(COMMANDS[i].name, name) == 0) {
+            return (replay_command_type) i;
+        }
+    }
+    return REPLAY_COMMAND_NONE;
+}
+
+static int parse_command(const char *line, replay_command *command)
+{
+    char name[32];
+    unsigned int iv1, iv2;
+    int length;
+    if (sscanf(line, "%d %x:%x %31s%n", &command->time, &iv1, &iv2, name, &length) != 4) {
+        return 0;
+    }
+    command->random_iv1 = iv1;
+    command->random_iv2 = iv2;
+    command->type = get_command_type(name);
+    if (command->type == REPLAY_COMMAND_NONE) {
+        return 0;
+    }
+    const char *params = &line[length];
+    for (int i = 0; i < COMMANDS[command->type].num_params; i++) {
+        if (sscanf(params, "%d%n", &command->params[i], &length) != 1) {
+            return 0;
+        }
+        params += length;
+    }
+    return 1;
+}
+
+int replay_load(const char *filename)
+{
+    free(data.commands);
+    data.commands = 0;
+    data.num_commands = 0;
+    data.next_command = 0;
+    data.errors = 0;
+
+    FILE *fp = file_open(filename, "r");
+    if (!fp) {
+        log_error("Unable to open replay", filename, 0);
+        return 0;
+    }
+    char line[MAX_LINE_LENGTH];
+    int version = 0;
+    if (!fgets(line, MAX_LINE_LENGTH, fp) || sscanf(line, "julius-replay %d", &version) != 1 ||
+        version != REPLAY_VERSION) {
+        log_error("Not a replay file", filename, version);
+        file_close(fp);
+        return 0;
+    }
+    int capacity = 0;
+    while (fgets(line, MAX_LINE_LENGTH, fp)) {
+        replay_command command;
+        if (!parse_command(line, &command)) {
+            // only the end of the recording is left
+            continue;
+        }
+        if (data.num_commands >= capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            replay_command *commands = (replay_command *) realloc(data.commands, capacity * sizeof(replay_command));
+            if (!commands) {
+                file_close(fp);
+                return 0;
+            }
+            data.commands = commands;
+        }
+        data.commands[data.num_commands++] = command;
+    }
+    file_close(fp);
+    log_info("Replay commands loaded:", 0, data.num_commands);
+    return 1;
+}
+
+static void run_command(const replay_command *command)
+{
+    const int *p = command->params;
+    switch (command->type) {
+        case REPLAY_COMMAND_CONSTRUCT:
+            building_construction_set_type((building_type) p[0]);
+            building_construction_start(p[1], p[2], map_grid_offset(p[1], p[2]));
+            building_construction_update(p[3], p[4], map_grid_offset(p[3], p[4]));
+            building_construction_set_road_orientation(p[5]);
+            building_construction_place();
+            building_construction_clear_type();
+            break;
+        case REPLAY_COMMAND_ROTATE:
+            if (p[0] == 0) {
+                game_orientation_rotate_left();
+            } else if (p[0] == 1) {
+                game_orientation_rotate_right();
+            } else {
+                game_orientation_rotate_north();
+            }
+            break;
+        case REPLAY_COMMAND_TAX:
+            city_finance_change_tax_percentage(p[0]);
+            break;
+        case REPLAY_COMMAND_WAGES:
+            city_labor_change_wages(p[0]);
+            break;
+        case REPLAY_COMMAND_LABOR_PRIORITY:
+            city_labor_set_priority(p[0], p[1]);
+            break;
+        case REPLAY_COMMAND_LEGION_MOVE:
+            formation_legion_move_to(formation_get(p[0]), p[1], p[2]);
+            break;
+        case REPLAY_COMMAND_LEGION_RETURN:
+            formation_legion_return_home(formation_get(p[0]));
+            break;
+        case REPLAY_COMMAND_LEGION_LAYOUT:
+            formation_legion_change_layout(formation_get(p[0]), p[1]);
+            break;
+        case REPLAY_COMMAND_STORAGE_CYCLE:
+            building_storage_cycle_resource_state(p[0], (resource_type) p[1]);
+            break;
+        case REPLAY_COMMAND_STORAGE_ACCEPT_NONE:
+            building_storage_accept_none(p[0]);
+            break;
+        case REPLAY_COMMAND_STORAGE_EMPTY_ALL:
+            building_storage_toggle_empty_all(p[0]);
+            break;
+        case REPLAY_COMMAND_OPEN_TRADE:
+            empire_city_open_trade(p[0]);
+            break;
+        case REPLAY_COMMAND_TRADE_STATUS:
+            city_resource_cycle_trade_status((resource_type) p[0]);
+            break;
+        case REPLAY_COMMAND_EXPORT_OVER:
+            city_resource_change_export_over((resource_type) p[0], p[1]);
+            break;
+        case REPLAY_COMMAND_STOCKPILE:
+            city_resource_toggle_stockpiled((resource_type) p[0]);
+            break;
+        case REPLAY_COMMAND_MOTHBALL:
+            city_resource_toggle_mothballed((resource_type) p[0]);
+            break;
+        case REPLAY_COMMAND_FESTIVAL:
+            city_festival_select_god(p[0]);
+            city_festival_select_size(p[1]);
+            city_festival_schedule();
+            break;
+        case REPLAY_COMMAND_UNDO:
+            game_undo_perform();
+            break;
+        case REPLAY_COMMAND_SEND_GIFT:
+            city_emperor_set_gift_size(p[0]);
+            city_emperor_send_gift();
+            break;
+        case REPLAY_COMMAND_DONATE:
+            city_emperor_set_donation_amount(p[0]);
+            city_emperor_donate_savings_to_city();
+            break;
+        case REPLAY_COMMAND_SALARY:
+            city_emperor_set_salary_rank(p[0]);
+            break;
+        case REPLAY_COMMAND_DISPATCH_REQUEST:
+            scenario_request_dispatch(p[0]);
+            break;
+        case REPLAY_COMMAND_EMPIRE_SERVICE:
+            formation_toggle_empire_service(p[0]);
+            break;
+        default:
+            break;
+    }
+}
+
+void replay_run_commands(void)
+{
+    if (data.next_command >= data.num_commands) {
+        return;
+    }
+    int time = current_time();
+    while (data.next_command < data.num_commands && data.commands[data.next_command].time <= time) {
+        const replay_command *command = &data.commands[data.next_command++];
+        uint32_t iv1, iv2;
+        get_random_state(&iv1, &iv2);
+        if (command->time != time || command->random_iv1 != iv1 || command->random_iv2 != iv2) {
+            log_error("Replay out of sync at command", COMMANDS[command->type].name, command->time);
+            data.errors++;
+        }
+        run_command(command);
+    }
+}
+
+int replay_errors(void)
+{
+    return data.errors;
+}
@@ -0,0 +1,81 @@
+#ifndef GAME_REPLAY_H
+#define GAME_REPLAY_H
+
+/**
+ * @file
+ * Recording and replaying of player commands.
+ * A replay starts from a saved game and lists every command that changes the game,
+ * together with the game tick it was given on and the state of the random generator.
+ */
+
+typedef enum {
+    REPLAY_COMMAND_NONE = 0,
+    REPLAY_COMMAND_CONSTRUCT = 1, /**< building type, x start, y start, x end, y end, road orientation */
+    REPLAY_COMMAND_ROTATE = 2, /**< 0 = left, 1 = right, 2 = north */
+    REPLAY_COMMAND_TAX = 3, /**< change of the tax percentage */
+    REPLAY_COMMAND_WAGES = 4, /**< change of the wages */
+    REPLAY_COMMAND_LABOR_PRIORITY = 5, /**< labor category, priority */
+    REPLAY_COMMAND_LEGION_MOVE = 6, /**< formation id, x, y */
+    REPLAY_COMMAND_LEGION_RETURN = 7, /**< formation id */
+    REPLAY_COMMAND_LEGION_LAYOUT = 8, /**< formation id, layout */
+    REPLAY_COMMAND_STORAGE_CYCLE = 9, /**< storage id, resource */
+    REPLAY_COMMAND_STORAGE_ACCEPT_NONE = 10, /**< storage id */
+    REPLAY_COMMAND_STORAGE_EMPTY_ALL = 11, /**< storage id */
+    REPLAY_COMMAND_OPEN_TRADE = 12, /**< empire city id */
+    REPLAY_COMMAND_TRADE_STATUS = 13, /**< resource */
+    REPLAY_COMMAND_EXPORT_OVER = 14, /**< resource, change of the amount */
+    REPLAY_COMMAND_STOCKPILE = 15, /**< resource */
+    REPLAY_COMMAND_MOTHBALL = 16, /**< resource */
+    REPLAY_COMMAND_FESTIVAL = 17, /**< god, size */
+    REPLAY_COMMAND_UNDO = 18, /**< no parameters */
+    REPLAY_COMMAND_SEND_GIFT = 19, /**< gift size */
+    REPLAY_COMMAND_DONATE = 20, /**< amount */
+    REPLAY_COMMAND_SALARY = 21, /**< salary rank */
+    REPLAY_COMMAND_DISPATCH_REQUEST = 22, /**< request id */
+    REPLAY_COMMAND_EMPIRE_SERVICE = 23, /**< formation id */
+    REPLAY_COMMAND_MAX = 24
+} replay_command_type;
+
+/**
+ * Sets the file to record replays to. Recording (re)starts whenever a game is started or loaded:
+ * the game at that moment is written as a saved game next to the replay, with extension .sav.
+ * Existing files are not overwritten: a number is added to the name instead, like replay-2.rpl
+ * @param filename Replay file
+ */
+void replay_set_recording_file(const char *filename);
+
+/**
+ * Starts recording from the current game, if a recording file is set
+ */
+void replay_start_recording(void);
+
+/**
+ * Stops recording and closes the replay file
+ */
+void replay_stop_recording(void);
+
+/**
+ * Records a player command. Does nothing when not recording.
+ * @param type Command type, followed by the integer parameters of that command
+ */
+void replay_record_command(replay_command_type type, ...);
+
+/**
+ * Loads a replay to run on the current game, which must be the game the replay was recorded from
+ * @param filename Replay file
+ * @return Boolean true on success, false on failure
+ */
+int replay_load(const char *filename);
+
+/**
+ * Runs the commands of the loaded replay that were given before the next tick
+ */
+void replay_run_commands(void);
+
+/**
+ * Number of commands of the loaded replay that did not find the game in the recorded state
+ * @return Number of commands out of sync
+ */
+int replay_errors(void);
+
+#endif // GAME_REPLAY_H
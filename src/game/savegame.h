@@ -0,0 +1,43 @@
+#ifndef GAME_SAVEGAME_H
+#define GAME_SAVEGAME_H
+
+#include <stdint.h>
+
+#define SAVEGAME_INFO_PLAYER_NAME_LENGTH 32
+#define SAVEGAME_INFO_SCENARIO_NAME_LENGTH 65
+#define SAVEGAME_THUMBNAIL_SIZE 64
+
+typedef enum {
+    SAVEGAME_THUMBNAIL_LAND = 0,
+    SAVEGAME_THUMBNAIL_TREE = 1,
+    SAVEGAME_THUMBNAIL_ROCK = 2,
+    SAVEGAME_THUMBNAIL_WATER = 3,
+    SAVEGAME_THUMBNAIL_ROAD = 4,
+    SAVEGAME_THUMBNAIL_WALL = 5,
+    SAVEGAME_THUMBNAIL_AQUEDUCT = 6,
+    SAVEGAME_THUMBNAIL_HOUSE = 7,
+    SAVEGAME_THUMBNAIL_BUILDING = 8,
+    SAVEGAME_THUMBNAIL_MAX = 9
+} savegame_thumbnail_tile;
+
+typedef struct {
+    uint8_t player_name[SAVEGAME_INFO_PLAYER_NAME_LENGTH];
+    uint8_t scenario_name[SAVEGAME_INFO_SCENARIO_NAME_LENGTH];
+    int mission;
+    int year;
+    int month;
+    int population;
+    int treasury;
+    int culture;
+    int prosperity;
+    int peace;
+    int favor;
+    uint8_t thumbnail[SAVEGAME_THUMBNAIL_SIZE * SAVEGAME_THUMBNAIL_SIZE];
+} savegame_info;
+
+/**
+ * Copy of the game state in memory, see game_file_create_snapshot()
+ */
+typedef struct game_snapshot game_snapshot;
+
+#endif // GAME_SAVEGAME_H
@@ -81,3 +81,9 @@ int game_speed_get_elapsed_ticks(void)
         return MAX_TICKS_PER_FRAME;
     }
 }
+
+void game_speed_reset(void)
+{
+    // the next check always runs one tick, like returning to the map from another window
+    data.last_check_was_valid = 0;
+}
@@ -3,4 +3,6 @@
 
 int game_speed_get_elapsed_ticks(void);
 
+void game_speed_reset(void);
+
 #endif // GAME_SPEED_H
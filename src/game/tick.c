@@ -32,6 +32,7 @@
 #include "figure/formation.h"
 #include "figuretype/crime.h"
 #include "game/file.h"
+#include "game/replay.h"
 #include "game/settings.h"
 #include "game/time.h"
 #include "game/tutorial.h"
@@ -53,6 +54,7 @@
 #include "scenario/random_event.h"
 #include "scenario/request.h"
 #include "sound/music.h"
+#include "widget/city_with_overlay.h"
 #include "widget/minimap.h"
 
 static void advance_year(void)
@@ -99,7 +101,7 @@ static void advance_month(void)
     city_festival_update();
     tutorial_on_month_tick();
     if (setting_monthly_autosave()) {
-        game_file_write_saved_game("autosave.sav");
+        game_file_write_saved_game_in_background("autosave.sav");
     }
 }
 
@@ -152,9 +154,9 @@ static void advance_tick(void)
         case 37: map_desirability_update(); break;
         case 38: building_update_desirability(); break;
         case 39: building_house_process_evolve_and_consume_goods(); break;
-        case 40: building_update_state(); break;
+        case 40: building_update_state(); city_with_overlay_invalidate(); break;
         case 43: building_maintenance_update_burning_ruins(); break;
-        case 44: building_maintenance_check_fire_collapse(); break;
+        case 44: building_maintenance_check_fire_collapse(); city_with_overlay_invalidate(); break;
         case 45: figure_generate_criminals(); break;
         case 46: building_industry_update_wheat_production(); break;
         case 48: house_service_decay_tax_collector(); break;
@@ -172,6 +174,7 @@ void game_tick_run(void)
         figure_action_handle(); // just update the flag figures
         return;
     }
+    replay_run_commands();
     random_generate_next();
     game_undo_reduce_time_available();
     advance_tick();
@@ -6,6 +6,7 @@
 #include "building/warehouse.h"
 #include "city/finance.h"
 #include "core/image.h"
+#include "game/replay.h"
 #include "game/resource.h"
 #include "graphics/window.h"
 #include "map/aqueduct.h"
@@ -202,6 +203,7 @@ void game_undo_perform(void)
     if (!game_can_undo()) {
         return;
     }
+    replay_record_command(REPLAY_COMMAND_UNDO);
     data.available = 0;
     city_finance_process_construction(-data.building_cost);
     if (data.type == BUILDING_CLEAR_LAND) {
@@ -6,11 +6,15 @@
 #include <stdlib.h>
 #include <string.h>
 
-static struct {
+typedef struct {
     color_t *pixels;
     int width;
     int height;
-} canvas;
+} canvas_info;
+
+static canvas_info canvas;
+static canvas_info screen_canvas;
+static int is_custom_canvas;
 
 static struct {
     int x_start;
@@ -22,7 +26,7 @@ static struct {
 static struct {
     int x;
     int y;
-} translation;
+} translation, screen_translation;
 
 static clip_info clip;
 
@@ -41,6 +45,34 @@ const void *graphics_canvas(void)
     return canvas.pixels;
 }
 
+void graphics_set_custom_canvas(color_t *pixels, int width, int height)
+{
+    if (!is_custom_canvas) {
+        is_custom_canvas = 1;
+        screen_canvas = canvas;
+        screen_translation.x = translation.x;
+        screen_translation.y = translation.y;
+    }
+    canvas.pixels = pixels;
+    canvas.width = width;
+    canvas.height = height;
+    translation.x = 0;
+    translation.y = 0;
+    graphics_reset_clip_rectangle();
+}
+
+void graphics_restore_screen_canvas(void)
+{
+    if (!is_custom_canvas) {
+        return;
+    }
+    is_custom_canvas = 0;
+    canvas = screen_canvas;
+    translation.x = screen_translation.x;
+    translation.y = screen_translation.y;
+    graphics_reset_clip_rectangle();
+}
+
 static void translate_clip(int dx, int dy)
 {
     clip_rectangle.x_start -= dx;
@@ -200,6 +232,11 @@ color_t *graphics_get_pixel(int x, int y)
     return &canvas.pixels[(translation.y + y) * canvas.width + (translation.x + x)];
 }
 
+int graphics_get_canvas_width(void)
+{
+    return canvas.width;
+}
+
 void graphics_clear_screen(void)
 {
     memset(canvas.pixels, 0, sizeof(color_t) * canvas.width * canvas.height);
@@ -28,6 +28,12 @@ typedef struct {
 void graphics_init_canvas(int width, int height);
 const void *graphics_canvas(void);
 
+/**
+ * Redirects all drawing to the given pixel buffer until graphics_restore_screen_canvas() is called
+ */
+void graphics_set_custom_canvas(color_t *pixels, int width, int height);
+void graphics_restore_screen_canvas(void);
+
 void graphics_in_dialog(void);
 void graphics_reset_dialog(void);
 
@@ -40,6 +46,11 @@ void graphics_draw_from_buffer(int x, int y, int width, int height, const color_
 
 color_t *graphics_get_pixel(int x, int y);
 
+/**
+ * @return Distance between rows of pixels of the current canvas, in pixels
+ */
+int graphics_get_canvas_width(void);
+
 void graphics_clear_screen(void);
 
 void graphics_draw_vertical_line(int x, int y1, int y2, color_t color);
@@ -0,0 +1,150 @@
+#include "scaler.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int resize_table(scaler_table *table, int size)
+{
+    if (size <= table->size) {
+        return 1;
+    }
+    int *index = (int *) realloc(table->index, size * sizeof(int));
+    if (!index) {
+        return 0;
+    }
+    table->index = index;
+    int *next = (int *) realloc(table->next, size * sizeof(int));
+    if (!next) {
+        return 0;
+    }
+    table->next = next;
+    table->size = size;
+    return 1;
+}
+
+static int fill_table(scaler_table *table, scaler_mode mode, int src_size, int dst_size)
+{
+    if (!resize_table(table, dst_size)) {
+        return 0;
+    }
+    for (int i = 0; i < dst_size; i++) {
+        int index, next;
+        if (mode == SCALER_AVERAGE) {
+            index = (int) ((i * (int64_t) src_size) / dst_size);
+            next = (int) (((i + 1) * (int64_t) src_size) / dst_size);
+            if (next <= index) {
+                next = index + 1;
+            }
+        } else {
+            index = (int) (((2 * i + 1) * (int64_t) src_size) / (2 * dst_size));
+            next = index;
+        }
+        table->index[i] = index;
+        table->next[i] = next;
+    }
+    return 1;
+}
+
+int scaler_set_size(scaler *s, scaler_mode mode, int src_width, int src_height, int dst_width, int dst_height)
+{
+    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) {
+        return 0;
+    }
+    if (s->x.index && s->mode == mode && s->src_width == src_width && s->src_height == src_height &&
+        s->dst_width == dst_width && s->dst_height == dst_height) {
+        return 1;
+    }
+    s->src_width = 0;
+    if (!fill_table(&s->x, mode, src_width, dst_width) || !fill_table(&s->y, mode, src_height, dst_height)) {
+        return 0;
+    }
+    s->mode = mode;
+    s->src_width = src_width;
+    s->src_height = src_height;
+    s->dst_width = dst_width;
+    s->dst_height = dst_height;
+    return 1;
+}
+
+static void draw_nearest(const scaler *s, const color_t *src, int src_stride, color_t *dst, int dst_stride,
+    int x, int y, int width, int height, color_t alpha)
+{
+    const int *x_index = &s->x.index[x];
+    for (int row = 0; row < height; row++, dst += dst_stride) {
+        int src_y = s->y.index[y + row];
+        if (row > 0 && src_y == s->y.index[y + row - 1]) {
+            // same source row: copy the row just drawn
+            memcpy(dst, dst - dst_stride, width * sizeof(color_t));
+            continue;
+        }
+        const color_t *line = &src[src_y * src_stride];
+        for (int i = 0; i < width; i++) {
+            dst[i] = alpha | line[x_index[i]];
+        }
+    }
+}
+
+static color_t average(const color_t *src, int src_stride, int x_start, int x_end, int y_start, int y_end)
+{
+    int r = 0, g = 0, b = 0;
+    int num_colors = 0;
+    int num_transparent = 0;
+    for (int y = y_start; y < y_end; y++) {
+        const color_t *line = &src[y * src_stride];
+        for (int x = x_start; x < x_end; x++) {
+            color_t color = line[x];
+            if (color == COLOR_SG2_TRANSPARENT) {
+                num_transparent++;
+            } else {
+                r += (color >> 16) & 0xff;
+                g += (color >> 8) & 0xff;
+                b += color & 0xff;
+                num_colors++;
+            }
+        }
+    }
+    if (num_transparent > num_colors) {
+        return COLOR_SG2_TRANSPARENT;
+    }
+    return ((r / num_colors) << 16) | ((g / num_colors) << 8) | (b / num_colors);
+}
+
+static void draw_average(const scaler *s, const color_t *src, int src_stride, color_t *dst, int dst_stride,
+    int x, int y, int width, int height, color_t alpha)
+{
+    const int *x_index = &s->x.index[x];
+    const int *x_next = &s->x.next[x];
+    for (int row = 0; row < height; row++, dst += dst_stride) {
+        int y_start = s->y.index[y + row];
+        int y_end = s->y.next[y + row];
+        for (int i = 0; i < width; i++) {
+            dst[i] = alpha | average(src, src_stride, x_index[i], x_next[i], y_start, y_end);
+        }
+    }
+}
+
+void scaler_draw(const scaler *s, const color_t *src, int src_stride, color_t *dst, int dst_stride,
+    int x, int y, int width, int height, color_t alpha)
+{
+    if (!s->src_width || x < 0 || y < 0 || width <= 0 || height <= 0 ||
+        x + width > s->dst_width || y + height > s->dst_height) {
+        return;
+    }
+    switch (s->mode) {
+        case SCALER_AVERAGE:
+            draw_average(s, src, src_stride, dst, dst_stride, x, y, width, height, alpha);
+            break;
+        default:
+            draw_nearest(s, src, src_stride, dst, dst_stride, x, y, width, height, alpha);
+            break;
+    }
+}
+
+void scaler_free(scaler *s)
+{
+    free(s->x.index);
+    free(s->x.next);
+    free(s->y.index);
+    free(s->y.next);
+    memset(s, 0, sizeof(scaler));
+}
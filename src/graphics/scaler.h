@@ -0,0 +1,70 @@
+#ifndef GRAPHICS_SCALER_H
+#define GRAPHICS_SCALER_H
+
+#include "graphics/color.h"
+
+/**
+ * @file
+ * Scaling of pixel buffers using precomputed source index tables.
+ * The tables only depend on the source and destination sizes, so they are calculated once
+ * and reused for every frame or image that is scaled between the same sizes.
+ */
+
+typedef enum {
+    SCALER_NEAREST = 0, /**< nearest source pixel, keeps hard pixel edges */
+    SCALER_AVERAGE = 1 /**< average of all source pixels covered, for scaling down images */
+} scaler_mode;
+
+typedef struct {
+    int *index; /**< first source pixel per destination pixel */
+    int *next; /**< one past the last source pixel for average */
+    int size;
+} scaler_table;
+
+typedef struct {
+    scaler_mode mode;
+    int src_width;
+    int src_height;
+    int dst_width;
+    int dst_height;
+    scaler_table x;
+    scaler_table y;
+} scaler;
+
+/**
+ * Prepares the scaler for the given sizes. Does nothing when the scaler was already prepared for them.
+ * @param s Scaler, zero-initialized on first use
+ * @param mode Scaling mode
+ * @param src_width Source width
+ * @param src_height Source height
+ * @param dst_width Destination width
+ * @param dst_height Destination height
+ * @return Boolean true on success, false when out of memory or when a size is zero
+ */
+int scaler_set_size(scaler *s, scaler_mode mode, int src_width, int src_height, int dst_width, int dst_height);
+
+/**
+ * Scales part of the source to the destination.
+ * With SCALER_AVERAGE, pixels of color COLOR_SG2_TRANSPARENT count as transparent:
+ * the result is transparent when most of the pixels covered are.
+ * @param s Prepared scaler
+ * @param src Source pixels
+ * @param src_stride Distance between source rows, in pixels
+ * @param dst Destination pixel for the top left of the part to draw
+ * @param dst_stride Distance between destination rows, in pixels
+ * @param x Left of the part to draw, in destination coordinates
+ * @param y Top of the part to draw, in destination coordinates
+ * @param width Width of the part to draw
+ * @param height Height of the part to draw
+ * @param alpha Alpha bits to add to every pixel drawn
+ */
+void scaler_draw(const scaler *s, const color_t *src, int src_stride, color_t *dst, int dst_stride,
+    int x, int y, int width, int height, color_t alpha);
+
+/**
+ * Frees the tables of the scaler
+ * @param s Scaler
+ */
+void scaler_free(scaler *s);
+
+#endif // GRAPHICS_SCALER_H
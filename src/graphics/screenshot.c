@@ -7,6 +7,7 @@
 #include "core/file.h"
 #include "core/log.h"
 #include "core/string.h"
+#include "core/thread.h"
 #include "graphics/screen.h"
 #include "graphics/graphics.h"
 #include "graphics/menu.h"
@@ -24,8 +25,9 @@
 
 #define TILE_X_SIZE 60
 #define TILE_Y_SIZE 30
-#define IMAGE_HEIGHT_CHUNK TILE_Y_SIZE
 #define IMAGE_BYTES_PER_PIXEL 3
+#define FULL_CITY_BAND_HEIGHT (8 * TILE_Y_SIZE)
+#define NUM_CITY_IMAGE_BANDS 2
 
 enum {
     FULL_CITY_SCREENSHOT = 0,
@@ -51,6 +53,25 @@ static struct {
     png_infop info_ptr;
 } image;
 
+typedef struct {
+    uint8_t *pixels;
+    int num_rows;
+} image_band;
+
+// bands are rendered on the main thread and written by a single writer thread, in order
+static struct {
+    image_band bands[NUM_CITY_IMAGE_BANDS];
+    int next_to_render;
+    int next_to_write;
+    int num_queued;
+    int finished;
+    int error;
+    thread *writer;
+    thread_mutex *mutex;
+    thread_condition *band_queued;
+    thread_condition *band_written;
+} city_image;
+
 static void image_free(void)
 {
     image.width = 0;
@@ -220,61 +241,283 @@ static void create_window_screenshot(void)
     image_free();
 }
 
-static void create_full_city_screenshot(void)
+static int image_write_band(void *data)
 {
-    if (!window_is(WINDOW_CITY) && !window_is(WINDOW_CITY_MILITARY)) {
-        return;
+    const image_band *band = (const image_band *) data;
+    if (setjmp(png_jmpbuf(image.png_ptr))) {
+        return 0;
     }
-    pixel_offset original_camera_pixels;
-    city_view_get_camera_in_pixels(&original_camera_pixels.x, &original_camera_pixels.y);
-    int width = screen_width();
-    int height = screen_height();
+    for (int y = 0; y < band->num_rows; y++) {
+        png_write_row(image.png_ptr, &band->pixels[y * image.row_size]);
+    }
+    return 1;
+}
+
+static int write_queued_bands(void *unused)
+{
+    thread_mutex_lock(city_image.mutex);
+    while (1) {
+        while (!city_image.num_queued && !city_image.finished) {
+            thread_condition_wait(city_image.band_queued, city_image.mutex);
+        }
+        if (!city_image.num_queued) {
+            break;
+        }
+        image_band *band = &city_image.bands[city_image.next_to_write];
+        int error = city_image.error;
+        thread_mutex_unlock(city_image.mutex);
+        // after an error, the PNG cannot be written anymore: only free the band
+        int ok = error || image_write_band(band);
+        thread_mutex_lock(city_image.mutex);
+        if (!ok) {
+            city_image.error = 1;
+        }
+        city_image.next_to_write = (city_image.next_to_write + 1) % NUM_CITY_IMAGE_BANDS;
+        city_image.num_queued--;
+        thread_condition_signal(city_image.band_written);
+    }
+    thread_mutex_unlock(city_image.mutex);
+    return 0;
+}
+
+static void city_image_stop_writer(void)
+{
+    if (city_image.writer) {
+        thread_mutex_lock(city_image.mutex);
+        city_image.finished = 1;
+        thread_condition_signal(city_image.band_queued);
+        thread_mutex_unlock(city_image.mutex);
+        thread_wait(city_image.writer);
+        city_image.writer = 0;
+    }
+    thread_condition_destroy(city_image.band_queued);
+    thread_condition_destroy(city_image.band_written);
+    thread_mutex_destroy(city_image.mutex);
+    city_image.band_queued = 0;
+    city_image.band_written = 0;
+    city_image.mutex = 0;
+}
+
+/**
+ * Starts the writer thread. Without it, the bands are written on the current thread.
+ */
+static void city_image_start_writer(void)
+{
+    city_image.next_to_render = 0;
+    city_image.next_to_write = 0;
+    city_image.num_queued = 0;
+    city_image.finished = 0;
+    city_image.error = 0;
+    city_image.mutex = thread_mutex_create();
+    city_image.band_queued = thread_condition_create();
+    city_image.band_written = thread_condition_create();
+    if (city_image.mutex && city_image.band_queued && city_image.band_written) {
+        city_image.writer = thread_create(write_queued_bands, "screenshot", 0);
+    }
+    if (!city_image.writer) {
+        city_image_stop_writer();
+    }
+}
+
+/**
+ * Waits until the writer is done with the band that is rendered next
+ * @return Band to render into
+ */
+static image_band *city_image_get_free_band(void)
+{
+    if (city_image.writer) {
+        thread_mutex_lock(city_image.mutex);
+        while (city_image.num_queued == NUM_CITY_IMAGE_BANDS) {
+            thread_condition_wait(city_image.band_written, city_image.mutex);
+        }
+        thread_mutex_unlock(city_image.mutex);
+    }
+    return &city_image.bands[city_image.next_to_render];
+}
 
+/**
+ * Queues the rendered band for writing, or writes it right away when there is no writer thread
+ * @return Boolean true if no error occurred so far
+ */
+static int city_image_write_band(void)
+{
+    image_band *band = &city_image.bands[city_image.next_to_render];
+    city_image.next_to_render = (city_image.next_to_render + 1) % NUM_CITY_IMAGE_BANDS;
+    if (!city_image.writer) {
+        return image_write_band(band);
+    }
+    thread_mutex_lock(city_image.mutex);
+    city_image.num_queued++;
+    int error = city_image.error;
+    thread_condition_signal(city_image.band_queued);
+    thread_mutex_unlock(city_image.mutex);
+    return !error;
+}
+
+/**
+ * Waits until all bands are written
+ * @return Boolean true if all bands were written without error
+ */
+static int city_image_finish_writing(void)
+{
+    city_image_stop_writer();
+    return !city_image.error;
+}
+
+static void city_image_free(void)
+{
+    city_image_stop_writer();
+    for (int i = 0; i < NUM_CITY_IMAGE_BANDS; i++) {
+        free(city_image.bands[i].pixels);
+        city_image.bands[i].pixels = 0;
+    }
+    image_free();
+}
+
+static int city_image_create(int width, int height, int band_rows)
+{
+    if (!image_create(width, height, band_rows)) {
+        return 0;
+    }
+    for (int i = 0; i < NUM_CITY_IMAGE_BANDS; i++) {
+        city_image.bands[i].pixels = (uint8_t *) malloc((size_t) image.row_size * band_rows);
+        city_image.bands[i].num_rows = 0;
+        if (!city_image.bands[i].pixels) {
+            city_image_free();
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Converts the rendered rows to RGB while shrinking them by the given scale,
+ * averaging each block of scale x scale pixels
+ */
+static void convert_rows(image_band *band, const color_t *canvas, int canvas_width, int num_rows, int scale)
+{
+    band->num_rows = num_rows / scale;
+    int area = scale * scale;
+    for (int y = 0; y < band->num_rows; y++) {
+        uint8_t *pixel = &band->pixels[y * image.row_size];
+        const color_t *row = &canvas[y * scale * canvas_width];
+        for (int x = 0; x < image.width; x++) {
+            if (scale == 1) {
+                color_t input = row[x];
+                *(pixel + 0) = (uint8_t) ((input & 0xff0000) >> 16);
+                *(pixel + 1) = (uint8_t) ((input & 0x00ff00) >> 8);
+                *(pixel + 2) = (uint8_t) ((input & 0x0000ff) >> 0);
+            } else {
+                int red = 0, green = 0, blue = 0;
+                for (int dy = 0; dy < scale; dy++) {
+                    const color_t *block = &row[dy * canvas_width + x * scale];
+                    for (int dx = 0; dx < scale; dx++) {
+                        red += (block[dx] & 0xff0000) >> 16;
+                        green += (block[dx] & 0x00ff00) >> 8;
+                        blue += block[dx] & 0x0000ff;
+                    }
+                }
+                *(pixel + 0) = (uint8_t) (red / area);
+                *(pixel + 1) = (uint8_t) (green / area);
+                *(pixel + 2) = (uint8_t) (blue / area);
+            }
+            pixel += 3;
+        }
+    }
+}
+
+int graphics_save_full_city_image(const char *filename, int scale, city_image_draw_function *draw)
+{
+    if (scale != 1 && scale != 2 && scale != 4) {
+        scale = 1;
+    }
     int city_width_pixels = map_grid_width() * TILE_X_SIZE;
     int city_height_pixels = map_grid_height() * TILE_Y_SIZE;
+    int total_height = city_height_pixels + TILE_Y_SIZE;
+    int band_height = total_height < FULL_CITY_BAND_HEIGHT ? total_height : FULL_CITY_BAND_HEIGHT;
 
-    if (!image_create(city_width_pixels, city_height_pixels + TILE_Y_SIZE, IMAGE_HEIGHT_CHUNK)) {
+    if (!city_image_create(city_width_pixels / scale, total_height / scale, band_height / scale)) {
         log_error("Unable to set memory for full city screenshot", 0, 0);
-        return;
+        return 0;
     }
-    const char *filename = generate_filename(FULL_CITY_SCREENSHOT);
     if (!image_begin_io(filename) || !image_write_header()) {
         log_error("Unable to write screenshot to:", filename, 0);
-        image_free();
-        return;
+        city_image_free();
+        return 0;
     }
 
+    // render offscreen, with the same layout as the city window so the regular city drawing can be used
     int canvas_width = city_width_pixels + (city_view_is_sidebar_collapsed() ? 40 : 160);
-    screen_set_resolution(canvas_width, TOP_MENU_HEIGHT + IMAGE_HEIGHT_CHUNK);
-    graphics_set_clip_rectangle(0, TOP_MENU_HEIGHT, city_width_pixels, IMAGE_HEIGHT_CHUNK);
+    int canvas_height = TOP_MENU_HEIGHT + band_height;
+    color_t *canvas = (color_t *) malloc(sizeof(color_t) * canvas_width * canvas_height);
+    if (!canvas) {
+        log_error("Unable to set memory for full city screenshot", 0, 0);
+        city_image_free();
+        return 0;
+    }
+    memset(canvas, 0, sizeof(color_t) * canvas_width * canvas_height);
+    pixel_offset original_camera_pixels;
+    city_view_get_camera_in_pixels(&original_camera_pixels.x, &original_camera_pixels.y);
+
+    graphics_set_custom_canvas(canvas, canvas_width, canvas_height);
+    city_view_set_viewport(canvas_width, canvas_height);
+    city_image_start_writer();
 
     int base_width = (GRID_SIZE * TILE_X_SIZE - city_width_pixels) / 2 + TILE_X_SIZE;
     int max_height = (GRID_SIZE * TILE_Y_SIZE + city_height_pixels) / 2;
-    int min_height = max_height - city_height_pixels - TILE_Y_SIZE;
-    map_tile dummy_tile = {0, 0, 0};
+    int min_height = max_height - total_height;
+    const color_t *band_pixels = canvas + TOP_MENU_HEIGHT * canvas_width;
     int error = 0;
-    int current_height = image_set_loop_height_limits(min_height, max_height);
-    int size;
-    const color_t *canvas = (color_t *) graphics_canvas() + TOP_MENU_HEIGHT * canvas_width;
-    while ((size = image_request_rows())) {
-        city_view_set_camera_from_pixel_position(base_width, current_height);
-        city_without_overlay_draw(0, 0, &dummy_tile);
-        if (!image_write_rows(canvas, canvas_width)) {
-            log_error("Error writing image", 0, 0);
+    for (int y = 0; y < total_height; y += band_height) {
+        int num_rows = band_height;
+        int row_offset = 0;
+        if (y + band_height > total_height) {
+            // keep the camera within bounds: render the last full band and skip the rows already written
+            num_rows = total_height - y;
+            row_offset = band_height - num_rows;
+        }
+        city_view_set_camera_from_pixel_position(base_width, min_height + y - row_offset);
+        // only draw the rows of this band
+        graphics_set_clip_rectangle(0, TOP_MENU_HEIGHT + row_offset, city_width_pixels, num_rows);
+        draw();
+        convert_rows(city_image_get_free_band(), band_pixels + row_offset * canvas_width, canvas_width, num_rows, scale);
+        if (!city_image_write_band()) {
             error = 1;
             break;
         }
-        current_height += size;
     }
-    graphics_reset_clip_rectangle();
-    screen_set_resolution(width, height);
+    if (!city_image_finish_writing()) {
+        error = 1;
+    }
+    graphics_restore_screen_canvas();
+    city_view_set_viewport(screen_width(), screen_height());
     city_view_set_camera_from_pixel_position(original_camera_pixels.x, original_camera_pixels.y);
-    if (!error) {
+    free(canvas);
+    if (error) {
+        log_error("Error writing image", 0, 0);
+    } else {
         image_finish();
         log_info("Saved full city screenshot:", filename, 0);
+    }
+    city_image_free();
+    return !error;
+}
+
+static void draw_city_without_overlay(void)
+{
+    map_tile dummy_tile = {0, 0, 0};
+    city_without_overlay_draw(0, 0, &dummy_tile);
+}
+
+static void create_full_city_screenshot(void)
+{
+    if (!window_is(WINDOW_CITY) && !window_is(WINDOW_CITY_MILITARY)) {
+        return;
+    }
+    const char *filename = generate_filename(FULL_CITY_SCREENSHOT);
+    if (graphics_save_full_city_image(filename, 1, draw_city_without_overlay)) {
         show_saved_notice(filename);
     }
-    image_free();
 }
 
 void graphics_save_screenshot(int full_city)
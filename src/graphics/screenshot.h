@@ -1,6 +1,18 @@
 #ifndef GRAPHICS_SCREENSHOT_H
 #define GRAPHICS_SCREENSHOT_H
 
+typedef void (city_image_draw_function)(void);
+
 void graphics_save_screenshot(int full_city);
 
+/**
+ * Renders the whole city offscreen in horizontal bands and saves it as PNG.
+ * PNG compression runs on a separate thread while the next band is rendered.
+ * @param filename File to save to
+ * @param scale Output scale divisor: 1 for full size, 2 for half size, 4 for quarter size
+ * @param draw Function that draws the city into the current viewport
+ * @return 1 on success, 0 on error
+ */
+int graphics_save_full_city_image(const char *filename, int scale, city_image_draw_function *draw);
+
 #endif // GRAPHICS_SCREENSHOT_H
@@ -7,12 +7,65 @@
 #include "graphics/graphics.h"
 #include "graphics/image.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #define ELLIPSIS_LENGTH 4
 #define NUMBER_BUFFER_LENGTH 100
+#define TMP_LINE_LENGTH 200
+#define MAX_MULTILINE_LINES 100
+
+#define GLYPH_CACHE_SIZE 512
+#define GLYPH_RUN_MAX_LENGTH 80
+#define MULTILINE_CACHE_SIZE 32
+
+static uint8_t tmp_line[TMP_LINE_LENGTH];
+
+typedef struct {
+    int letter_id;
+    int16_t x;
+    int16_t y;
+} glyph;
+
+/**
+ * A single line of text laid out for drawing: the letters to draw with their offsets,
+ * so drawing does not need to look up letters and widths again
+ */
+typedef struct {
+    int in_use;
+    uint32_t hash;
+    font_t font;
+    int box_width;
+    int length;
+    uint8_t text[GLYPH_RUN_MAX_LENGTH];
+    int text_width;
+    int draw_width;
+    int num_glyphs;
+    glyph glyphs[GLYPH_RUN_MAX_LENGTH + ELLIPSIS_LENGTH];
+} glyph_run;
+
+typedef struct {
+    int start;
+    int length;
+} text_line;
+
+typedef struct {
+    int in_use;
+    uint32_t hash;
+    font_t font;
+    int box_width;
+    int length;
+    int text_size;
+    uint8_t *text;
+    int num_lines;
+    int largest_width;
+    text_line lines[MAX_MULTILINE_LINES];
+} multiline_layout;
 
-static uint8_t tmp_line[200];
+static struct {
+    glyph_run runs[GLYPH_CACHE_SIZE];
+    multiline_layout layouts[MULTILINE_CACHE_SIZE];
+} cache;
 
 static struct {
     int capture;
@@ -41,6 +94,30 @@ static int get_ellipsis_width(font_t font)
     return ellipsis.width[font];
 }
 
+static uint32_t hash_text(const uint8_t *str, int length, font_t font, int box_width)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash = (hash ^ str[i]) * 16777619u;
+    }
+    hash = (hash ^ (uint32_t) font) * 16777619u;
+    return (hash ^ (uint32_t) box_width) * 16777619u;
+}
+
+void text_invalidate_cache(void)
+{
+    for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+        cache.runs[i].in_use = 0;
+    }
+    for (int i = 0; i < MULTILINE_CACHE_SIZE; i++) {
+        cache.layouts[i].in_use = 0;
+    }
+    for (int i = 0; i < FONT_TYPES_MAX; i++) {
+        ellipsis.width[i] = 0;
+    }
+}
+
 void text_capture_cursor(int cursor_position, int offset_start, int offset_end)
 {
     input_cursor.capture = 1;
@@ -86,7 +163,7 @@ void text_draw_cursor(int x_offset, int y_offset, int is_insert)
     }
 }
 
-int text_get_width(const uint8_t *str, font_t font)
+static int get_text_width(const uint8_t *str, font_t font)
 {
     const font_definition *def = font_definition_for(font);
     int maxlen = 10000;
@@ -232,6 +309,87 @@ static int get_word_width(const uint8_t *str, font_t font, int *out_num_chars)
     return width;
 }
 
+static void layout_glyph_run(glyph_run *run, const uint8_t *str, font_t font)
+{
+    const font_definition *def = font_definition_for(font);
+    int length = string_length(str);
+    int current_x = 0;
+    run->num_glyphs = 0;
+    while (length > 0) {
+        int num_bytes = 1;
+        if (*str >= ' ') {
+            int letter_id = font_letter_id(def, str, &num_bytes);
+            if (*str == ' ' || *str == '_' || letter_id < 0) {
+                current_x += def->space_width;
+            } else {
+                const image *img = image_letter(letter_id);
+                glyph *g = &run->glyphs[run->num_glyphs++];
+                g->letter_id = letter_id;
+                g->x = (int16_t) current_x;
+                g->y = (int16_t) -def->image_y_offset(*str, img->height, def->line_height);
+                current_x += def->letter_spacing + img->width;
+            }
+        }
+        str += num_bytes;
+        length -= num_bytes;
+    }
+    run->draw_width = current_x + def->space_width;
+}
+
+/**
+ * Returns the laid out run for the text, ellipsized to box_width when it is not 0.
+ * Texts too long for the cache return 0 and have to be drawn directly.
+ */
+static const glyph_run *get_glyph_run(const uint8_t *str, font_t font, int box_width)
+{
+    int length = string_length(str);
+    if (length >= GLYPH_RUN_MAX_LENGTH) {
+        return 0;
+    }
+    uint32_t hash = hash_text(str, length, font, box_width);
+    glyph_run *run = &cache.runs[hash % GLYPH_CACHE_SIZE];
+    if (run->in_use && run->hash == hash && run->font == font && run->box_width == box_width &&
+        run->length == length && memcmp(run->text, str, length) == 0) {
+        return run;
+    }
+    const uint8_t *layout_str = str;
+    uint8_t ellipsized[GLYPH_RUN_MAX_LENGTH + ELLIPSIS_LENGTH];
+    if (box_width) {
+        // text_ellipsize may use the cache itself, so this has to happen before the run is filled
+        string_copy(str, ellipsized, GLYPH_RUN_MAX_LENGTH);
+        text_ellipsize(ellipsized, font, box_width);
+        layout_str = ellipsized;
+    }
+    layout_glyph_run(run, layout_str, font);
+    run->text_width = get_text_width(layout_str, font);
+    run->in_use = 1;
+    run->hash = hash;
+    run->font = font;
+    run->box_width = box_width;
+    run->length = length;
+    memcpy(run->text, str, length);
+    return run;
+}
+
+static int draw_glyph_run(const glyph_run *run, int x, int y, color_t color)
+{
+    font_t image_font = font_definition_for(run->font)->font;
+    for (int i = 0; i < run->num_glyphs; i++) {
+        const glyph *g = &run->glyphs[i];
+        image_draw_letter(image_font, g->letter_id, x + g->x, y + g->y, color);
+    }
+    return run->draw_width;
+}
+
+int text_get_width(const uint8_t *str, font_t font)
+{
+    const glyph_run *run = get_glyph_run(str, font, 0);
+    if (run) {
+        return run->text_width;
+    }
+    return get_text_width(str, font);
+}
+
 void text_draw_centered(const uint8_t *str, int x, int y, int box_width, font_t font, color_t color)
 {
     int offset = (box_width - text_get_width(str, font)) / 2;
@@ -243,6 +401,13 @@ void text_draw_centered(const uint8_t *str, int x, int y, int box_width, font_t
 
 void text_draw_ellipsized(const uint8_t *str, int x, int y, int box_width, font_t font, color_t color)
 {
+    if (!input_cursor.capture) {
+        const glyph_run *run = get_glyph_run(str, font, box_width);
+        if (run) {
+            draw_glyph_run(run, x, y, color);
+            return;
+        }
+    }
     static uint8_t buffer[1000];
     string_copy(str, buffer, 1000);
     text_ellipsize(buffer, font, box_width);
@@ -251,6 +416,12 @@ void text_draw_ellipsized(const uint8_t *str, int x, int y, int box_width, font_
 
 int text_draw(const uint8_t *str, int x, int y, font_t font, color_t color)
 {
+    if (!input_cursor.capture) {
+        const glyph_run *run = get_glyph_run(str, font, 0);
+        if (run) {
+            return draw_glyph_run(run, x, y, color);
+        }
+    }
     const font_definition *def = font_definition_for(font);
 
     int length = string_length(str);
@@ -370,25 +541,21 @@ void text_draw_number_centered_colored(
     text_draw_centered(str, x_offset, y_offset, box_width, font, color);
 }
 
-int text_draw_multiline(const uint8_t *str, int x_offset, int y_offset, int box_width, font_t font, uint32_t color)
+static void layout_multiline(multiline_layout *layout, const uint8_t *str, int box_width, font_t font)
 {
-    int line_height = font_definition_for(font)->line_height;
-    if (line_height < 11) {
-        line_height = 11;
-    }
+    const uint8_t *text = str;
     int has_more_characters = 1;
     int guard = 0;
-    int y = y_offset;
+    layout->num_lines = 0;
+    layout->largest_width = 0;
     while (has_more_characters) {
-        if (++guard >= 100) {
+        if (++guard >= MAX_MULTILINE_LINES) {
             break;
         }
-        // clear line
-        for (int i = 0; i < 200; i++) {
-            tmp_line[i] = 0;
-        }
         int current_width = 0;
-        int line_index = 0;
+        text_line *line = &layout->lines[layout->num_lines];
+        line->start = (int) (str - text);
+        line->length = 0;
         while (has_more_characters) {
             int word_num_chars;
             int word_width = get_word_width(str, font, &word_num_chars);
@@ -400,11 +567,12 @@ int text_draw_multiline(const uint8_t *str, int x_offset, int y_offset, int box_
             } else {
                 current_width += word_width;
                 for (int i = 0; i < word_num_chars; i++) {
-                    if (line_index == 0 && *str <= ' ') {
-                        str++; // skip whitespace at start of line
+                    if (line->length == 0 && *str <= ' ') {
+                        line->start++; // skip whitespace at start of line
                     } else {
-                        tmp_line[line_index++] = *str++;
+                        line->length++;
                     }
+                    str++;
                 }
                 if (!*str) {
                     has_more_characters = 0;
@@ -414,6 +582,55 @@ int text_draw_multiline(const uint8_t *str, int x_offset, int y_offset, int box_
                 }
             }
         }
+        if (current_width > layout->largest_width) {
+            layout->largest_width = current_width;
+        }
+        layout->num_lines++;
+    }
+}
+
+static const multiline_layout *get_multiline_layout(const uint8_t *str, int box_width, font_t font)
+{
+    static multiline_layout uncached;
+    int length = string_length(str);
+    uint32_t hash = hash_text(str, length, font, box_width);
+    multiline_layout *layout = &cache.layouts[hash % MULTILINE_CACHE_SIZE];
+    if (layout->in_use && layout->hash == hash && layout->font == font && layout->box_width == box_width &&
+        layout->length == length && memcmp(layout->text, str, length) == 0) {
+        return layout;
+    }
+    if (layout->text_size <= length) {
+        uint8_t *text = (uint8_t *) realloc(layout->text, length + 1);
+        if (!text) {
+            layout_multiline(&uncached, str, box_width, font);
+            return &uncached;
+        }
+        layout->text = text;
+        layout->text_size = length + 1;
+    }
+    layout_multiline(layout, str, box_width, font);
+    layout->in_use = 1;
+    layout->hash = hash;
+    layout->font = font;
+    layout->box_width = box_width;
+    layout->length = length;
+    memcpy(layout->text, str, length);
+    return layout;
+}
+
+int text_draw_multiline(const uint8_t *str, int x_offset, int y_offset, int box_width, font_t font, uint32_t color)
+{
+    int line_height = font_definition_for(font)->line_height;
+    if (line_height < 11) {
+        line_height = 11;
+    }
+    const multiline_layout *layout = get_multiline_layout(str, box_width, font);
+    int y = y_offset;
+    for (int i = 0; i < layout->num_lines; i++) {
+        const text_line *line = &layout->lines[i];
+        int length = line->length < TMP_LINE_LENGTH ? line->length : TMP_LINE_LENGTH - 1;
+        memcpy(tmp_line, str + line->start, length);
+        tmp_line[length] = 0;
         text_draw(tmp_line, x_offset, y, font, color);
         y += line_height + 5;
     }
@@ -422,40 +639,9 @@ int text_draw_multiline(const uint8_t *str, int x_offset, int y_offset, int box_
 
 int text_measure_multiline(const uint8_t *str, int box_width, font_t font, int *largest_width)
 {
+    const multiline_layout *layout = get_multiline_layout(str, box_width, font);
     if (largest_width) {
-        *largest_width = 0;
-    }
-    int has_more_characters = 1;
-    int guard = 0;
-    int num_lines = 0;
-    while (has_more_characters) {
-        if (++guard >= 100) {
-            break;
-        }
-        int current_width = 0;
-        while (has_more_characters) {
-            int word_num_chars;
-            int word_width = get_word_width(str, font, &word_num_chars);
-            if (current_width + word_width >= box_width) {
-                if (current_width == 0) {
-                    has_more_characters = 0;
-                }
-                break;
-            } else {
-                current_width += word_width;
-                str += word_num_chars;
-                if (!*str) {
-                    has_more_characters = 0;
-                } else if (*str == '\n') {
-                    str++;
-                    break;
-                }
-            }
-        }
-        if (largest_width && current_width > *largest_width) {
-            *largest_width = current_width;
-        }
-        num_lines += 1;
+        *largest_width = layout->largest_width;
     }
-    return num_lines;
+    return layout->num_lines;
 }
@@ -7,6 +7,11 @@
 
 #include <stdint.h>
 
+/**
+ * Clears the cached text layouts, must be called when the language or fonts change
+ */
+void text_invalidate_cache(void);
+
 void text_capture_cursor(int cursor_position, int offset_start, int offset_end);
 void text_draw_cursor(int x_offset, int y_offset, int is_insert);
 
@@ -3,14 +3,32 @@
 #include "core/dir.h"
 #include "core/file.h"
 #include "core/smacker.h"
+#include "core/thread.h"
 #include "core/time.h"
 #include "game/settings.h"
 #include "graphics/graphics.h"
+#include "graphics/scaler.h"
 #include "graphics/screen.h"
 #include "sound/device.h"
 #include "sound/music.h"
 #include "sound/speech.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#define QUEUE_SIZE 4
+
+typedef struct {
+    color_t *pixels;
+    color_t *scaled;
+    int scaled_width;
+    int scaled_height;
+    int scaled_size;
+    uint8_t *audio;
+    int audio_len;
+    int audio_size;
+} video_frame;
+
 static struct {
     int is_playing;
     int is_ended;
@@ -19,6 +37,7 @@ static struct {
     struct {
         int width;
         int height;
+        int frame_height;
         int y_scale;
         int micros_per_frame;
         time_millis start_render_millis;
@@ -32,16 +51,207 @@ static struct {
     } audio;
 
     int restart_music;
+
+    // frames decoded ahead by the decoder thread; the current frame is never overwritten
+    struct {
+        video_frame frames[QUEUE_SIZE];
+        int current;
+        int first;
+        int count;
+        int finished;
+        int stop;
+        int fullscreen_width;
+        int fullscreen_height;
+        scaler decoder_scaler;
+        scaler render_scaler;
+        thread *decoder;
+        thread_mutex *mutex;
+        thread_condition *condition;
+    } queue;
 } data;
 
+static void lock_queue(void)
+{
+    if (data.queue.mutex) {
+        thread_mutex_lock(data.queue.mutex);
+    }
+}
+
+static void unlock_queue(void)
+{
+    if (data.queue.mutex) {
+        thread_mutex_unlock(data.queue.mutex);
+    }
+}
+
+static void scale_frame(video_frame *frame, int width, int height)
+{
+    frame->scaled_width = frame->scaled_height = 0;
+    int size = width * height;
+    if (size > frame->scaled_size) {
+        color_t *scaled = (color_t *) realloc(frame->scaled, size * sizeof(color_t));
+        if (!scaled) {
+            return;
+        }
+        frame->scaled = scaled;
+        frame->scaled_size = size;
+    }
+    scaler *s = &data.queue.decoder_scaler;
+    if (!scaler_set_size(s, SCALER_NEAREST, data.video.width, data.video.frame_height, width, height)) {
+        return;
+    }
+    scaler_draw(s, frame->pixels, data.video.width, frame->scaled, width, 0, 0, width, height, ALPHA_OPAQUE);
+    frame->scaled_width = width;
+    frame->scaled_height = height;
+}
+
+static void store_frame(video_frame *frame, int fullscreen_width, int fullscreen_height)
+{
+    const unsigned char *video = smacker_get_frame_video(data.s);
+    const uint32_t *pal = smacker_get_frame_palette(data.s);
+    int num_pixels = data.video.width * data.video.frame_height;
+    for (int i = 0; i < num_pixels; i++) {
+        frame->pixels[i] = pal[video[i]];
+    }
+    frame->scaled_width = frame->scaled_height = 0;
+    if (fullscreen_width > 0 && fullscreen_height > 0) {
+        scale_frame(frame, fullscreen_width, fullscreen_height);
+    }
+    frame->audio_len = 0;
+    if (data.audio.has_audio) {
+        int audio_len = smacker_get_frame_audio_size(data.s, 0);
+        if (audio_len > frame->audio_size) {
+            uint8_t *audio = (uint8_t *) realloc(frame->audio, audio_len);
+            if (!audio) {
+                return;
+            }
+            frame->audio = audio;
+            frame->audio_size = audio_len;
+        }
+        if (audio_len > 0) {
+            memcpy(frame->audio, smacker_get_frame_audio(data.s, 0), audio_len);
+            frame->audio_len = audio_len;
+        }
+    }
+}
+
+/**
+ * Decodes the next frame into the queue. Must be called with the queue locked.
+ */
+static void decode_next_frame(void)
+{
+    video_frame *frame = &data.queue.frames[(data.queue.first + data.queue.count) % QUEUE_SIZE];
+    int width = data.queue.fullscreen_width;
+    int height = data.queue.fullscreen_height;
+    unlock_queue();
+    int decoded = smacker_next_frame(data.s) == SMACKER_FRAME_OK;
+    if (decoded) {
+        store_frame(frame, width, height);
+    }
+    lock_queue();
+    if (decoded) {
+        data.queue.count++;
+    } else {
+        data.queue.finished = 1;
+    }
+    if (data.queue.condition) {
+        thread_condition_broadcast(data.queue.condition);
+    }
+}
+
+static int decode_frames(void *unused)
+{
+    lock_queue();
+    while (!data.queue.stop) {
+        if (data.queue.finished || data.queue.count >= QUEUE_SIZE - 1) {
+            thread_condition_wait(data.queue.condition, data.queue.mutex);
+        } else {
+            decode_next_frame();
+        }
+    }
+    unlock_queue();
+    return 0;
+}
+
+static const video_frame *take_next_frame(void)
+{
+    lock_queue();
+    while (!data.queue.count && !data.queue.finished) {
+        if (data.queue.decoder) {
+            thread_condition_wait(data.queue.condition, data.queue.mutex);
+        } else {
+            decode_next_frame();
+        }
+    }
+    const video_frame *frame = 0;
+    if (data.queue.count) {
+        data.queue.current = data.queue.first;
+        data.queue.first = (data.queue.first + 1) % QUEUE_SIZE;
+        data.queue.count--;
+        frame = &data.queue.frames[data.queue.current];
+        if (data.queue.condition) {
+            thread_condition_broadcast(data.queue.condition);
+        }
+    }
+    unlock_queue();
+    return frame;
+}
+
+static void start_decoder(void)
+{
+    data.queue.mutex = thread_mutex_create();
+    data.queue.condition = thread_condition_create();
+    if (data.queue.mutex && data.queue.condition) {
+        data.queue.decoder = thread_create(decode_frames, "video decoder", 0);
+    }
+    // without a thread, frames are decoded when they are needed
+}
+
+static void stop_decoder(void)
+{
+    if (data.queue.decoder) {
+        lock_queue();
+        data.queue.stop = 1;
+        thread_condition_broadcast(data.queue.condition);
+        unlock_queue();
+        thread_wait(data.queue.decoder);
+    }
+    if (data.queue.condition) {
+        thread_condition_destroy(data.queue.condition);
+    }
+    if (data.queue.mutex) {
+        thread_mutex_destroy(data.queue.mutex);
+    }
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        free(data.queue.frames[i].pixels);
+        free(data.queue.frames[i].scaled);
+        free(data.queue.frames[i].audio);
+    }
+    scaler_free(&data.queue.decoder_scaler);
+    scaler_free(&data.queue.render_scaler);
+    memset(&data.queue, 0, sizeof(data.queue));
+}
+
 static void close_smk(void)
 {
+    stop_decoder();
     if (data.s) {
         smacker_close(data.s);
         data.s = 0;
     }
 }
 
+static int allocate_frames(void)
+{
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        data.queue.frames[i].pixels = (color_t *) malloc(data.video.width * data.video.frame_height * sizeof(color_t));
+        if (!data.queue.frames[i].pixels) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 static int load_smk(const char *filename)
 {
     const char *path = dir_get_file(filename, MAY_BE_LOCALIZED);
@@ -61,6 +271,7 @@ static int load_smk(const char *filename)
 
     data.video.width = width;
     data.video.height = y_scale == SMACKER_Y_SCALE_NONE ? height : height * 2;
+    data.video.frame_height = height;
     data.video.y_scale = y_scale;
     data.video.current_frame = 0;
     data.video.micros_per_frame = micros_per_frame;
@@ -77,10 +288,14 @@ static int load_smk(const char *filename)
         }
     }
 
-    if (smacker_first_frame(data.s) != SMACKER_FRAME_OK) {
+    if (!allocate_frames() || smacker_first_frame(data.s) != SMACKER_FRAME_OK) {
         close_smk();
         return 0;
     }
+    store_frame(&data.queue.frames[0], 0, 0);
+    data.queue.current = 0;
+    data.queue.first = 1;
+    start_decoder();
     return 1;
 }
 
@@ -119,11 +334,12 @@ void video_init(int restart_music)
     data.restart_music = restart_music;
 
     if (data.audio.has_audio) {
-        int audio_len = smacker_get_frame_audio_size(data.s, 0);
-        if (audio_len > 0) {
+        // the decoder may be ahead already: use the audio stored with the first frame
+        const video_frame *frame = &data.queue.frames[data.queue.current];
+        if (frame->audio_len > 0) {
             sound_device_use_custom_music_player(
                 data.audio.bitdepth, data.audio.channels, data.audio.rate,
-                smacker_get_frame_audio(data.s, 0), audio_len
+                frame->audio, frame->audio_len
             );
         }
     }
@@ -163,7 +379,8 @@ static int get_next_frame(void)
     int frame_no = (now_millis - data.video.start_render_millis) * 1000 / data.video.micros_per_frame;
     int draw_frame = data.video.current_frame == 0;
     while (frame_no > data.video.current_frame) {
-        if (smacker_next_frame(data.s) != SMACKER_FRAME_OK) {
+        const video_frame *frame = take_next_frame();
+        if (!frame) {
             close_smk();
             data.is_ended = 1;
             data.is_playing = 0;
@@ -173,11 +390,8 @@ static int get_next_frame(void)
         data.video.current_frame++;
         draw_frame = 1;
 
-        if (data.audio.has_audio) {
-            int audio_len = smacker_get_frame_audio_size(data.s, 0);
-            if (audio_len > 0) {
-                sound_device_write_custom_music_data(smacker_get_frame_audio(data.s, 0), audio_len);
-            }
+        if (data.audio.has_audio && frame->audio_len > 0) {
+            sound_device_write_custom_music_data(frame->audio, frame->audio_len);
         }
     }
     return draw_frame;
@@ -192,19 +406,14 @@ void video_draw(int x_offset, int y_offset)
     if (!clip->is_visible) {
         return;
     }
-    const unsigned char *frame = smacker_get_frame_video(data.s);
-    const uint32_t *pal = smacker_get_frame_palette(data.s);
-    if (frame && pal) {
-        for (int y = clip->clipped_pixels_top; y < clip->visible_pixels_y; y++) {
-            color_t *pixel = graphics_get_pixel(
-                x_offset + clip->clipped_pixels_left, y + y_offset + clip->clipped_pixels_top);
-            int video_y = data.video.y_scale == SMACKER_Y_SCALE_NONE ? y : y / 2;
-            const unsigned char *line = frame + (video_y * data.video.width);
-            for (int x = clip->clipped_pixels_left; x < clip->visible_pixels_x; x++) {
-                *pixel = pal[line[x]];
-                ++pixel;
-            }
-        }
+    const video_frame *frame = &data.queue.frames[data.queue.current];
+    int line_width = clip->visible_pixels_x - clip->clipped_pixels_left;
+    for (int y = clip->clipped_pixels_top; y < clip->visible_pixels_y; y++) {
+        color_t *pixel = graphics_get_pixel(
+            x_offset + clip->clipped_pixels_left, y + y_offset + clip->clipped_pixels_top);
+        int video_y = data.video.y_scale == SMACKER_Y_SCALE_NONE ? y : y / 2;
+        const color_t *line = &frame->pixels[video_y * data.video.width];
+        memcpy(pixel, &line[clip->clipped_pixels_left], line_width * sizeof(color_t));
     }
 }
 
@@ -215,29 +424,42 @@ void video_draw_fullscreen(void)
     }
     int s_width = screen_width();
     int s_height = screen_height();
-    const unsigned char *frame = smacker_get_frame_video(data.s);
-    const uint32_t *pal = smacker_get_frame_palette(data.s);
-    if (frame && pal) {
-        double scale_w = s_width / (double) data.video.width;
-        double scale_h = s_height / (double) data.video.height * (data.video.y_scale == SMACKER_Y_SCALE_NONE ? 1 : 2);
-        double scale = scale_w < scale_h ? scale_w : scale_h;
-        int video_width = (int) (scale * data.video.width);
-        int video_height = (int) (scale * data.video.height);
-        int x_offset = (s_width - video_width) / 2;
-        int y_offset = (s_height - video_height) / 2;
-        const clip_info *clip = graphics_get_clip_info(x_offset, y_offset, video_width, video_height);
-        if (!clip->is_visible) {
-            return;
-        }
-        for (int y = clip->clipped_pixels_top; y < video_height - clip->clipped_pixels_bottom; y++) {
-            color_t *pixel = graphics_get_pixel(x_offset + clip->clipped_pixels_left, y_offset + y);
-            int x_max = video_width - clip->clipped_pixels_right;
-            int video_y = (int) ((data.video.y_scale == SMACKER_Y_SCALE_NONE ? y : y / 2) / scale);
-            const unsigned char *line = frame + (video_y * data.video.width);
-            for (int x = clip->clipped_pixels_left; x < x_max; x++) {
-                *pixel = ALPHA_OPAQUE | pal[line[(int)(x / scale)]];
-                ++pixel;
-            }
+    double scale_w = s_width / (double) data.video.width;
+    double scale_h = s_height / (double) data.video.height * (data.video.y_scale == SMACKER_Y_SCALE_NONE ? 1 : 2);
+    double scale = scale_w < scale_h ? scale_w : scale_h;
+    int video_width = (int) (scale * data.video.width);
+    int video_height = (int) (scale * data.video.height);
+
+    if (video_width != data.queue.fullscreen_width || video_height != data.queue.fullscreen_height) {
+        // let the decoder thread scale the next frames
+        lock_queue();
+        data.queue.fullscreen_width = video_width;
+        data.queue.fullscreen_height = video_height;
+        unlock_queue();
+    }
+    const video_frame *frame = &data.queue.frames[data.queue.current];
+
+    int x_offset = (s_width - video_width) / 2;
+    int y_offset = (s_height - video_height) / 2;
+    const clip_info *clip = graphics_get_clip_info(x_offset, y_offset, video_width, video_height);
+    if (!clip->is_visible) {
+        return;
+    }
+    int line_width = video_width - clip->clipped_pixels_right - clip->clipped_pixels_left;
+    if (frame->scaled_width != video_width || frame->scaled_height != video_height) {
+        // not scaled ahead for this size: scale straight to the screen
+        scaler *s = &data.queue.render_scaler;
+        if (scaler_set_size(s, SCALER_NEAREST, data.video.width, data.video.frame_height, video_width, video_height)) {
+            scaler_draw(s, frame->pixels, data.video.width,
+                graphics_get_pixel(x_offset + clip->clipped_pixels_left, y_offset + clip->clipped_pixels_top),
+                graphics_get_canvas_width(), clip->clipped_pixels_left, clip->clipped_pixels_top, line_width,
+                video_height - clip->clipped_pixels_bottom - clip->clipped_pixels_top, ALPHA_OPAQUE);
         }
+        return;
+    }
+    for (int y = clip->clipped_pixels_top; y < video_height - clip->clipped_pixels_bottom; y++) {
+        color_t *pixel = graphics_get_pixel(x_offset + clip->clipped_pixels_left, y_offset + y);
+        const color_t *line = &frame->scaled[y * video_width];
+        memcpy(pixel, &line[clip->clipped_pixels_left], line_width * sizeof(color_t));
     }
 }
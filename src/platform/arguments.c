@@ -8,6 +8,12 @@
 #define DISPLAY_SCALE_ERROR_MESSAGE "Option --display-scale must be followed by a scale value between 0.5 and 5"
 #define WINDOWED_AND_FULLSCREEN_ERROR_MESSAGE "Option --windowed and --fullscreen cannot both be specified"
 #define DISPLAY_ID_ERROR_MESSAGE "Option --display must be followed by a number indicating the display, starting from 0"
+#define EXPORT_LIST_ERROR_MESSAGE "Option --export-city-images must be followed by a file listing the saved games to export"
+#define EXPORT_OVERLAY_ERROR_MESSAGE "Option --export-overlay must be followed by the name of an overlay"
+#define EXPORT_SCALE_ERROR_MESSAGE "Option --export-scale must be followed by a scale value of 1, 2 or 4"
+#define EXPORT_WORKERS_ERROR_MESSAGE "Option --export-workers must be followed by a number of processes between 1 and 64"
+#define CONVERT_SAVE_ERROR_MESSAGE "Option --convert-save must be followed by the format (compact or legacy), an input file and an output file"
+#define RECORD_REPLAY_ERROR_MESSAGE "Option --record-replay must be followed by the file to record to"
 #define UNKNOWN_OPTION_ERROR_MESSAGE "Option %s not recognized"
 
 static void print_log(const char *message)
@@ -71,6 +77,14 @@ int platform_parse_arguments(int argc, char **argv, julius_args *output_args)
     output_args->force_windowed = 0;
     output_args->force_fullscreen = 0;
     output_args->display_id = 0;
+    output_args->export_list = 0;
+    output_args->export_overlay = 0;
+    output_args->export_scale = 1;
+    output_args->export_workers = 0;
+    output_args->convert_format = 0;
+    output_args->convert_input = 0;
+    output_args->convert_output = 0;
+    output_args->record_replay = 0;
 
     for (int i = 1; i < argc; i++) {
         // we ignore "-psn" arguments, this is needed to launch the app
@@ -115,6 +129,65 @@ int platform_parse_arguments(int argc, char **argv, julius_args *output_args)
                 print_log(DISPLAY_ID_ERROR_MESSAGE);
                 ok = 0;
             }
+        } else if (SDL_strcmp(argv[i], "--export-city-images") == 0) {
+            if (i + 1 < argc) {
+                output_args->export_list = argv[i + 1];
+                i++;
+            } else {
+                print_log(EXPORT_LIST_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--export-overlay") == 0) {
+            if (i + 1 < argc) {
+                output_args->export_overlay = argv[i + 1];
+                i++;
+            } else {
+                print_log(EXPORT_OVERLAY_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--export-scale") == 0) {
+            int scale = 0;
+            if (i + 1 < argc) {
+                scale = SDL_strtol(argv[i + 1], 0, 10);
+                i++;
+            }
+            if (scale == 1 || scale == 2 || scale == 4) {
+                output_args->export_scale = scale;
+            } else {
+                print_log(EXPORT_SCALE_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--export-workers") == 0) {
+            int workers = 0;
+            if (i + 1 < argc) {
+                workers = SDL_strtol(argv[i + 1], 0, 10);
+                i++;
+            }
+            if (workers >= 1 && workers <= 64) {
+                output_args->export_workers = workers;
+            } else {
+                print_log(EXPORT_WORKERS_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--convert-save") == 0) {
+            if (i + 3 < argc &&
+                (SDL_strcmp(argv[i + 1], "compact") == 0 || SDL_strcmp(argv[i + 1], "legacy") == 0)) {
+                output_args->convert_format = argv[i + 1];
+                output_args->convert_input = argv[i + 2];
+                output_args->convert_output = argv[i + 3];
+                i += 3;
+            } else {
+                print_log(CONVERT_SAVE_ERROR_MESSAGE);
+                ok = 0;
+            }
+        } else if (SDL_strcmp(argv[i], "--record-replay") == 0) {
+            if (i + 1 < argc) {
+                output_args->record_replay = argv[i + 1];
+                i++;
+            } else {
+                print_log(RECORD_REPLAY_ERROR_MESSAGE);
+                ok = 0;
+            }
         } else if (SDL_strcmp(argv[i], "--windowed") == 0) {
             output_args->force_windowed = 1;
         } else if (SDL_strcmp(argv[i], "--fullscreen") == 0) {
@@ -150,6 +223,22 @@ int platform_parse_arguments(int argc, char **argv, julius_args *output_args)
         print_log("          Forces the game to start fullscreen");
         print_log("--display ID");
         print_log("          Forces the game to start on the specified display, numbered from 0");
+        print_log("--export-city-images FILE");
+        print_log("          Does not start the game: saves a PNG image of the whole city for every saved game");
+        print_log("          listed in FILE, one per line. Each image is written next to its saved game");
+        print_log("--export-overlay NAME");
+        print_log("          Draws the given overlay on the exported images, for example: fire, crime, water");
+        print_log("--export-scale NUMBER");
+        print_log("          Shrinks the exported images by a factor of NUMBER. Number can be 1, 2 or 4");
+        print_log("--export-workers NUMBER");
+        print_log("          Number of processes to export with. Defaults to the number of CPUs");
+        print_log("--convert-save FORMAT INPUT OUTPUT");
+        print_log("          Does not start the game: converts saved game INPUT to FORMAT and writes it to OUTPUT.");
+        print_log("          FORMAT can be compact (smaller, Julius only) or legacy (readable by Caesar 3)");
+        print_log("--record-replay FILE");
+        print_log("          Records the commands given in every started or loaded game to FILE.");
+        print_log("          The game at the start of the recording is saved next to it with extension .sav.");
+        print_log("          Existing recordings are kept: later ones get a number added, like FILE-2");
         print_log("The last argument, if present, is interpreted as data directory for the Caesar 3 installation");
     }
     return ok;
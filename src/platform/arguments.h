@@ -8,6 +8,14 @@ typedef struct {
     int force_windowed;
     int force_fullscreen;
     int display_id;
+    const char *export_list;
+    const char *export_overlay;
+    int export_scale;
+    int export_workers;
+    const char *convert_format;
+    const char *convert_input;
+    const char *convert_output;
+    const char *record_replay;
 } julius_args;
 
 int platform_parse_arguments(int argc, char **argv, julius_args *output_args);
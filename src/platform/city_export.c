@@ -0,0 +1,259 @@
+#include "city_export.h"
+
+#include "core/file.h"
+#include "core/image.h"
+#include "core/log.h"
+#include "core/thread.h"
+#include "game/file.h"
+#include "game/state.h"
+#include "graphics/screenshot.h"
+#include "map/grid.h"
+#include "widget/city_with_overlay.h"
+#include "widget/city_without_overlay.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__) && !defined(__ANDROID__) && \
+    !defined(__IPHONEOS__) && !defined(__SWITCH__) && !defined(__vita__)
+#define USE_WORKER_PROCESSES
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define MAX_EXIT_STATUS 255
+#define MAX_WORKER_PROCESSES 64
+
+static const struct {
+    const char *name;
+    int overlay;
+} OVERLAY_NAMES[] = {
+    {"water", OVERLAY_WATER},
+    {"religion", OVERLAY_RELIGION},
+    {"fire", OVERLAY_FIRE},
+    {"damage", OVERLAY_DAMAGE},
+    {"crime", OVERLAY_CRIME},
+    {"entertainment", OVERLAY_ENTERTAINMENT},
+    {"theater", OVERLAY_THEATER},
+    {"amphitheater", OVERLAY_AMPHITHEATER},
+    {"colosseum", OVERLAY_COLOSSEUM},
+    {"hippodrome", OVERLAY_HIPPODROME},
+    {"education", OVERLAY_EDUCATION},
+    {"school", OVERLAY_SCHOOL},
+    {"library", OVERLAY_LIBRARY},
+    {"academy", OVERLAY_ACADEMY},
+    {"barber", OVERLAY_BARBER},
+    {"bathhouse", OVERLAY_BATHHOUSE},
+    {"clinic", OVERLAY_CLINIC},
+    {"hospital", OVERLAY_HOSPITAL},
+    {"tax_income", OVERLAY_TAX_INCOME},
+    {"food_stocks", OVERLAY_FOOD_STOCKS},
+    {"desirability", OVERLAY_DESIRABILITY},
+    {"native", OVERLAY_NATIVE},
+    {"problems", OVERLAY_PROBLEMS}
+};
+
+#define NUM_OVERLAY_NAMES ((int) (sizeof(OVERLAY_NAMES) / sizeof(OVERLAY_NAMES[0])))
+
+static struct {
+    char **files;
+    int num_files;
+    int capacity;
+    const char *overlay_name;
+    int overlay;
+} data;
+
+static int find_overlay(const char *name)
+{
+    for (int i = 0; i < NUM_OVERLAY_NAMES; i++) {
+        if (strcmp(OVERLAY_NAMES[i].name, name) == 0) {
+            return OVERLAY_NAMES[i].overlay;
+        }
+    }
+    return OVERLAY_NONE;
+}
+
+static int add_file(const char *filename)
+{
+    if (data.num_files >= data.capacity) {
+        int capacity = data.capacity ? data.capacity * 2 : 16;
+        char **files = (char **) realloc(data.files, capacity * sizeof(char *));
+        if (!files) {
+            return 0;
+        }
+        data.files = files;
+        data.capacity = capacity;
+    }
+    char *copy = (char *) malloc(strlen(filename) + 1);
+    if (!copy) {
+        return 0;
+    }
+    strcpy(copy, filename);
+    data.files[data.num_files++] = copy;
+    return 1;
+}
+
+static char *trim(char *line)
+{
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    size_t length = strlen(line);
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r' ||
+            line[length - 1] == ' ' || line[length - 1] == '\t')) {
+        line[--length] = 0;
+    }
+    return line;
+}
+
+int platform_city_export_init(const char *list_file, const char *overlay_name)
+{
+    data.overlay = OVERLAY_NONE;
+    data.overlay_name = overlay_name;
+    if (overlay_name) {
+        data.overlay = find_overlay(overlay_name);
+        if (data.overlay == OVERLAY_NONE) {
+            log_error("Unknown overlay:", overlay_name, 0);
+            return 0;
+        }
+    }
+    FILE *fp = file_open(list_file, "r");
+    if (!fp) {
+        log_error("Unable to open list of saved games:", list_file, 0);
+        return 0;
+    }
+    char line[FILE_NAME_MAX];
+    int ok = 1;
+    while (ok && fgets(line, FILE_NAME_MAX, fp)) {
+        const char *filename = trim(line);
+        if (*filename && *filename != '#') {
+            ok = add_file(filename);
+        }
+    }
+    file_close(fp);
+    if (!ok) {
+        log_error("Out of memory reading list of saved games", 0, 0);
+        return 0;
+    }
+    if (!data.num_files) {
+        log_error("No saved games listed in:", list_file, 0);
+        return 0;
+    }
+    return 1;
+}
+
+static void get_image_filename(const char *filename, char *image_filename)
+{
+    const char *extension = 0;
+    for (const char *c = filename; *c; c++) {
+        if (*c == '.') {
+            extension = c;
+        } else if (*c == '/' || *c == '\\') {
+            extension = 0;
+        }
+    }
+    size_t length = extension ? (size_t) (extension - filename) : strlen(filename);
+    if (length > FILE_NAME_MAX - 32) {
+        length = FILE_NAME_MAX - 32;
+    }
+    memcpy(image_filename, filename, length);
+    image_filename[length] = 0;
+    if (data.overlay_name) {
+        strcat(image_filename, "_");
+        strncat(image_filename, data.overlay_name, 20);
+    }
+    strcat(image_filename, ".png");
+}
+
+static void draw_city_without_overlay(void)
+{
+    map_tile dummy_tile = {0, 0, 0};
+    city_without_overlay_draw(0, 0, &dummy_tile);
+}
+
+static void draw_city_with_overlay(void)
+{
+    map_tile dummy_tile = {0, 0, 0};
+    city_with_overlay_draw(&dummy_tile);
+}
+
+static int export_city(const char *filename, int scale)
+{
+    if (!game_file_load_saved_game_headless(filename)) {
+        log_error("Unable to export saved game:", filename, 0);
+        return 0;
+    }
+    game_state_set_overlay(data.overlay);
+    city_with_overlay_invalidate();
+    city_with_overlay_update();
+
+    char image_filename[FILE_NAME_MAX];
+    get_image_filename(filename, image_filename);
+    return graphics_save_full_city_image(image_filename, scale,
+        data.overlay == OVERLAY_NONE ? draw_city_without_overlay : draw_city_with_overlay);
+}
+
+static int export_files(int first, int step, int scale)
+{
+    int failed = 0;
+    for (int i = first; i < data.num_files; i += step) {
+        if (!export_city(data.files[i], scale)) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+#ifdef USE_WORKER_PROCESSES
+static int export_in_worker_processes(int scale, int workers)
+{
+    pid_t pids[MAX_WORKER_PROCESSES];
+    int failed = 0;
+    for (int i = 0; i < workers; i++) {
+        // the loaded game data is shared with the workers, so they can start exporting right away
+        image_stop_background_decoding();
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            failed = export_files(i, workers, scale);
+            _exit(failed > MAX_EXIT_STATUS ? MAX_EXIT_STATUS : failed);
+        } else if (pids[i] < 0) {
+            log_error("Unable to start export process, exporting in main process instead", 0, i);
+            failed += export_files(i, workers, scale);
+        }
+    }
+    for (int i = 0; i < workers; i++) {
+        if (pids[i] <= 0) {
+            continue;
+        }
+        int status;
+        if (waitpid(pids[i], &status, 0) != pids[i] || !WIFEXITED(status)) {
+            log_error("Export process crashed", 0, i);
+            failed++;
+        } else {
+            failed += WEXITSTATUS(status);
+        }
+    }
+    return failed;
+}
+#endif
+
+int platform_city_export_run(int scale, int workers)
+{
+    if (workers <= 0) {
+        workers = thread_cpu_count();
+    }
+    if (workers > data.num_files) {
+        workers = data.num_files;
+    }
+#ifdef USE_WORKER_PROCESSES
+    if (workers > MAX_WORKER_PROCESSES) {
+        workers = MAX_WORKER_PROCESSES;
+    }
+    if (workers > 1) {
+        log_info("Exporting city images, number of processes:", 0, workers);
+        return export_in_worker_processes(scale, workers);
+    }
+#endif
+    return export_files(0, 1, scale);
+}
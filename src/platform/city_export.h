@@ -0,0 +1,28 @@
+#ifndef PLATFORM_CITY_EXPORT_H
+#define PLATFORM_CITY_EXPORT_H
+
+/**
+ * @file
+ * Batch export of full city images, without creating a window.
+ */
+
+/**
+ * Reads the list of saved games to export. Must be called before changing to the data directory,
+ * so the list file can be given relative to the working directory
+ * @param list_file File containing one saved game per line. Relative paths are resolved against
+ *        the Caesar 3 data directory, empty lines and lines starting with '#' are ignored
+ * @param overlay_name Name of the overlay to draw, or 0 for the plain city
+ * @return Boolean true on success, false if the list could not be read or the overlay is unknown
+ */
+int platform_city_export_init(const char *list_file, const char *overlay_name);
+
+/**
+ * Exports the listed saved games as PNG images next to the saved game files.
+ * The game must have been initialized with game_init_headless()
+ * @param scale Scale down factor: 1, 2 or 4
+ * @param workers Number of processes to export with, 0 to use one per CPU
+ * @return Number of saved games that could not be exported
+ */
+int platform_city_export_run(int scale, int workers);
+
+#endif // PLATFORM_CITY_EXPORT_H
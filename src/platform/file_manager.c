@@ -9,10 +9,18 @@
 #include "platform/vita/vita.h"
 
 #include <dirent.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 
+#if !defined(_WIN32) && !defined(__ANDROID__) && !defined(__EMSCRIPTEN__) && !defined(__vita__) && !defined(__SWITCH__)
+#define USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #ifdef _MSC_VER
 // Of course MSVC is the only compiler that doesn't have POSIX strcasecmp...
 #include <mbstring.h>
@@ -248,6 +256,16 @@ int platform_file_manager_remove_file(const char *filename)
     return result == 0;
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    wchar_t *wfile = utf8_to_wchar(filename);
+    wchar_t *wnew_file = utf8_to_wchar(new_filename);
+    int result = MoveFileExW(wfile, wnew_file, MOVEFILE_REPLACE_EXISTING);
+    free(wfile);
+    free(wnew_file);
+    return result != 0;
+}
+
 #elif defined(__ANDROID__)
 
 FILE *platform_file_manager_open_file(const char *filename, const char *mode)
@@ -264,6 +282,31 @@ int platform_file_manager_remove_file(const char *filename)
     return android_remove_file(filename);
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    // files are accessed through the storage access framework, which cannot rename: copy instead
+    FILE *in = platform_file_manager_open_file(filename, "rb");
+    if (!in) {
+        return 0;
+    }
+    FILE *out = platform_file_manager_open_file(new_filename, "wb");
+    if (!out) {
+        fclose(in);
+        return 0;
+    }
+    char buffer[4096];
+    size_t bytes_read;
+    int ok = 1;
+    while (ok && (bytes_read = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        ok = fwrite(buffer, 1, bytes_read, out) == bytes_read;
+    }
+    fclose(in);
+    if (fclose(out) != 0) {
+        ok = 0;
+    }
+    return ok && android_remove_file(filename);
+}
+
 #elif defined(__EMSCRIPTEN__)
 
 FILE *platform_file_manager_open_file(const char *filename, const char *mode)
@@ -283,6 +326,17 @@ int platform_file_manager_remove_file(const char *filename)
     return 0;
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    if (rename(filename, new_filename) == 0) {
+        EM_ASM(
+            Module.syncFS();
+        );
+        return 1;
+    }
+    return 0;
+}
+
 #else
 
 FILE *platform_file_manager_open_file(const char *filename, const char *mode)
@@ -307,6 +361,19 @@ int platform_file_manager_remove_file(const char *filename)
     return remove(filename) == 0;
 }
 
+int platform_file_manager_rename_file(const char *filename, const char *new_filename)
+{
+    if (rename(filename, new_filename) != 0) {
+        return 0;
+    }
+#ifdef USE_FILE_CACHE
+    platform_file_manager_cache_delete_file_info(filename);
+    platform_file_manager_cache_delete_file_info(new_filename);
+    platform_file_manager_cache_add_file_info(new_filename);
+#endif
+    return 1;
+}
+
 #endif
 
 int platform_file_manager_close_file(FILE *stream)
@@ -322,3 +389,107 @@ int platform_file_manager_close_file(FILE *stream)
 #endif
     return result;
 }
+
+#if defined(_WIN32)
+
+const void *platform_file_manager_map_file(const char *filename, int *size)
+{
+    wchar_t *wfile = utf8_to_wchar(filename);
+    HANDLE file = CreateFileW(wfile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    free(wfile);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    const void *data = NULL;
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 && file_size.QuadPart < INT_MAX) {
+        HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            // the view keeps the mapping alive
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+    if (data) {
+        *size = (int) file_size.QuadPart;
+    }
+    return data;
+}
+
+void platform_file_manager_unmap_file(const void *data, int size)
+{
+    UnmapViewOfFile(data);
+}
+
+int platform_file_manager_get_file_info(const char *filename, int *size, int64_t *modified)
+{
+    wchar_t *wfile = utf8_to_wchar(filename);
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    int result = GetFileAttributesExW(wfile, GetFileExInfoStandard, &attributes);
+    free(wfile);
+    if (!result || attributes.nFileSizeHigh || attributes.nFileSizeLow >= INT_MAX) {
+        return 0;
+    }
+    *size = (int) attributes.nFileSizeLow;
+    *modified = ((int64_t) attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    return 1;
+}
+
+#elif defined(USE_MMAP)
+
+const void *platform_file_manager_map_file(const char *filename, int *size)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    void *data = NULL;
+    struct stat file_info;
+    if (fstat(fd, &file_info) == 0 && S_ISREG(file_info.st_mode) &&
+        file_info.st_size > 0 && file_info.st_size < INT_MAX) {
+        data = mmap(NULL, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = NULL;
+        } else {
+            *size = (int) file_info.st_size;
+        }
+    }
+    close(fd);
+    return data;
+}
+
+void platform_file_manager_unmap_file(const void *data, int size)
+{
+    munmap((void *) data, size);
+}
+
+int platform_file_manager_get_file_info(const char *filename, int *size, int64_t *modified)
+{
+    struct stat file_info;
+    if (stat(filename, &file_info) != 0 || !S_ISREG(file_info.st_mode) || file_info.st_size >= INT_MAX) {
+        return 0;
+    }
+    *size = (int) file_info.st_size;
+    *modified = (int64_t) file_info.st_mtime;
+    return 1;
+}
+
+#else
+
+const void *platform_file_manager_map_file(const char *filename, int *size)
+{
+    // files are read with stdio instead
+    return NULL;
+}
+
+void platform_file_manager_unmap_file(const void *data, int size)
+{
+}
+
+int platform_file_manager_get_file_info(const char *filename, int *size, int64_t *modified)
+{
+    return 0;
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef PLATFORM_FILE_MANAGER_H
 #define PLATFORM_FILE_MANAGER_H
 
+#include <stdint.h>
 #include <stdio.h>
 
 enum {
@@ -81,4 +82,36 @@ int platform_file_manager_close_file(FILE *stream);
  */
 int platform_file_manager_remove_file(const char *filename);
 
+/**
+ * Renames a file, replacing the destination file if it exists
+ * @param filename The file to rename
+ * @param new_filename The new name of the file
+ * @return true if renaming was successful, false otherwise
+ */
+int platform_file_manager_rename_file(const char *filename, const char *new_filename);
+
+/**
+ * Maps a file into memory for reading
+ * @param filename The file to map
+ * @param size Output: the size of the file
+ * @return The read-only contents of the file, or NULL if the file cannot be mapped
+ */
+const void *platform_file_manager_map_file(const char *filename, int *size);
+
+/**
+ * Unmaps a file mapped with platform_file_manager_map_file()
+ * @param data The contents of the file
+ * @param size The size of the file
+ */
+void platform_file_manager_unmap_file(const void *data, int size);
+
+/**
+ * Gets the size and the last modification time of a file without reading it
+ * @param filename The file to check
+ * @param size Output: the size of the file
+ * @param modified Output: the last modification time, in platform-specific units
+ * @return true if the information is available, false otherwise
+ */
+int platform_file_manager_get_file_info(const char *filename, int *size, int64_t *modified);
+
 #endif // PLATFORM_FILE_MANAGER_H
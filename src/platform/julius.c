@@ -6,13 +6,16 @@
 #include "core/file.h"
 #include "core/lang.h"
 #include "core/time.h"
+#include "game/file.h"
 #include "game/game.h"
+#include "game/replay.h"
 #include "game/settings.h"
 #include "game/system.h"
 #include "graphics/screen.h"
 #include "input/mouse.h"
 #include "input/touch.h"
 #include "platform/arguments.h"
+#include "platform/city_export.h"
 #include "platform/file_manager.h"
 #include "platform/file_manager_cache.h"
 #include "platform/joystick.h"
@@ -634,6 +637,41 @@ static void setup(const julius_args *args)
     data.active = 1;
 }
 
+static int export_city_images(const julius_args *args)
+{
+    setup_logging();
+
+    SDL_Log("Julius version %s", system_version());
+
+    // the list has to be read before the data directory becomes the working directory
+    if (!platform_city_export_init(args->export_list, args->export_overlay)) {
+        return 1;
+    }
+    if (args->data_directory && !platform_file_manager_set_base_path(args->data_directory)) {
+        SDL_Log("%s: directory not found", args->data_directory);
+        return 1;
+    }
+    if (!game_pre_init() || !game_init_headless()) {
+        SDL_Log("Exiting: game init failed");
+        return 1;
+    }
+    int failed = platform_city_export_run(args->export_scale, args->export_workers);
+    if (failed) {
+        SDL_Log("Unable to export %d saved games", failed);
+    }
+    teardown_logging();
+    return failed ? 1 : 0;
+}
+
+static int convert_saved_game(const julius_args *args)
+{
+    setup_logging();
+    int compact = SDL_strcmp(args->convert_format, "compact") == 0;
+    int result = game_file_convert_saved_game(args->convert_input, args->convert_output, compact);
+    teardown_logging();
+    return result ? 0 : 1;
+}
+
 int main(int argc, char **argv)
 {
     julius_args args;
@@ -644,6 +682,16 @@ int main(int argc, char **argv)
 #endif
     }
 
+    if (args.export_list) {
+        exit_with_status(export_city_images(&args));
+    }
+    if (args.convert_format) {
+        exit_with_status(convert_saved_game(&args));
+    }
+    if (args.record_replay) {
+        replay_set_recording_file(args.record_replay);
+    }
+
     setup(&args);
 
     mouse_set_inside_window(1);
@@ -1,5 +1,7 @@
+#include "core/config.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/thread.h"
 #include "sound/device.h"
 #include "game/settings.h"
 #include "platform/platform.h"
@@ -21,6 +23,8 @@
 #define AUDIO_BUFFERS 1024
 
 #define MAX_CHANNELS 150
+#define MAX_PREFETCHED_MUSIC 2
+#define MIX_BLOCK_SAMPLES 2048
 
 #if SDL_VERSION_ATLEAST(2, 0, 7)
 #define USE_SDL_AUDIOSTREAM
@@ -38,6 +42,13 @@ static struct {
 typedef struct {
     const char *filename;
     Mix_Chunk *chunk;
+} sound_sample;
+
+typedef struct {
+    sound_sample *sample;
+    char file[FILE_NAME_MAX];
+    Mix_Chunk *file_chunk;
+    Mix_Chunk *playing;
 } sound_channel;
 
 static struct {
@@ -46,6 +57,57 @@ static struct {
     sound_channel channels[MAX_CHANNELS];
 } data;
 
+// decoded sound files of the channels, shared between channels that use the same file
+static struct {
+    sound_sample samples[MAX_CHANNELS];
+    int num_samples;
+    thread *loader;
+    thread_mutex *mutex;
+    int stop_loading;
+} pool;
+
+typedef struct {
+    const Mix_Chunk *chunk;
+    Uint32 position;
+    int volume;
+    int left;
+    int right;
+} mixer_voice;
+
+// optional mixer for the sound channels, used instead of the SDL_mixer channels
+static struct {
+    int enabled;
+    thread_mutex *mutex;
+    mixer_voice voices[MAX_CHANNELS];
+    Sint32 block[MIX_BLOCK_SAMPLES];
+    Uint64 mix_ticks;
+    Uint64 max_mix_ticks;
+    Uint32 num_mixes;
+} mixer;
+
+typedef enum {
+    PREFETCH_NONE,
+    PREFETCH_QUEUED,
+    PREFETCH_LOADING,
+    PREFETCH_READY
+} prefetch_state;
+
+typedef struct {
+    char filename[FILE_NAME_MAX];
+    Mix_Music *music;
+    prefetch_state state;
+} prefetched_music;
+
+// music files opened ahead on a background thread, so that changing tracks does not stall a frame
+static struct {
+    prefetched_music tracks[MAX_PREFETCHED_MUSIC];
+    int next_replace;
+    thread *loader;
+    thread_mutex *mutex;
+    thread_condition *condition;
+    int stop;
+} prefetch;
+
 static struct {
     SDL_AudioFormat format;
     SDL_AudioFormat dst_format;
@@ -65,12 +127,140 @@ static int percentage_to_volume(int percentage)
     return percentage * SDL_MIX_MAXVOLUME / 100;
 }
 
-static void init_channels(void)
+static void mix_voices(const mixer_voice *voices, Sint32 *block, int num_samples)
 {
-    data.initialized = 1;
+    for (int i = 0; i < num_samples; i++) {
+        block[i] = 0;
+    }
+    for (int v = 0; v < MAX_CHANNELS; v++) {
+        const mixer_voice *voice = &voices[v];
+        if (!voice->chunk) {
+            continue;
+        }
+        const Sint16 *src = (const Sint16 *) (voice->chunk->abuf + voice->position);
+        int available = (int) ((voice->chunk->alen - voice->position) / sizeof(Sint16));
+        int samples = available < num_samples ? available : num_samples;
+        // volume 0 - 128 times panning 0 - 255: 1.0 is 32768
+        Sint32 left = voice->volume * voice->left;
+        Sint32 right = voice->volume * voice->right;
+        for (int i = 0; i + 1 < samples; i += 2) {
+            block[i] += (src[i] * left) >> 15;
+            block[i + 1] += (src[i + 1] * right) >> 15;
+        }
+    }
+}
+
+static void advance_voices(mixer_voice *voices, int num_samples)
+{
+    for (int v = 0; v < MAX_CHANNELS; v++) {
+        mixer_voice *voice = &voices[v];
+        if (voice->chunk) {
+            voice->position += num_samples * sizeof(Sint16);
+            if (voice->position >= voice->chunk->alen) {
+                voice->chunk = 0;
+            }
+        }
+    }
+}
+
+static void mix_channels(void *unused, Uint8 *stream, int len)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    Sint16 *output = (Sint16 *) stream;
+    int total_samples = len / (int) sizeof(Sint16);
+    thread_mutex_lock(mixer.mutex);
+    for (int offset = 0; offset < total_samples; offset += MIX_BLOCK_SAMPLES) {
+        int num_samples = total_samples - offset < MIX_BLOCK_SAMPLES ? total_samples - offset : MIX_BLOCK_SAMPLES;
+        mix_voices(mixer.voices, mixer.block, num_samples);
+        advance_voices(mixer.voices, num_samples);
+        Sint16 *out = &output[offset];
+        for (int i = 0; i < num_samples; i++) {
+            Sint32 sample = out[i] + mixer.block[i];
+            out[i] = (Sint16) (sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample);
+        }
+    }
+    Uint64 ticks = SDL_GetPerformanceCounter() - start;
+    mixer.mix_ticks += ticks;
+    if (ticks > mixer.max_mix_ticks) {
+        mixer.max_mix_ticks = ticks;
+    }
+    mixer.num_mixes++;
+    thread_mutex_unlock(mixer.mutex);
+}
+
+static void start_mixer(void)
+{
+    int rate, channels;
+    Uint16 format;
+    if (!config_get(CONFIG_SOUND_SOFTWARE_MIXER) || !Mix_QuerySpec(&rate, &format, &channels)) {
+        return;
+    }
+    // the sound files are converted to the device format when loaded: only 16-bit stereo is mixed here
+    if (format != AUDIO_S16SYS || channels != 2) {
+        log_info("Software mixer not supported for the audio format, channels:", 0, channels);
+        return;
+    }
+    mixer.mutex = thread_mutex_create();
+    if (!mixer.mutex) {
+        return;
+    }
     for (int i = 0; i < MAX_CHANNELS; i++) {
-        data.channels[i].chunk = 0;
+        mixer.voices[i].volume = SDL_MIX_MAXVOLUME;
+        mixer.voices[i].left = 255;
+        mixer.voices[i].right = 255;
     }
+    mixer.enabled = 1;
+    Mix_SetPostMix(mix_channels, 0);
+    log_info("Using software mixer", 0, 0);
+}
+
+static void stop_mixer(void)
+{
+    if (!mixer.enabled) {
+        return;
+    }
+    Mix_SetPostMix(0, 0);
+    thread_mutex_lock(mixer.mutex);
+    if (mixer.num_mixes) {
+        Uint64 frequency = SDL_GetPerformanceFrequency();
+        log_info("Software mixer average microseconds per mix:", 0,
+            (int) (mixer.mix_ticks * 1000000 / frequency / mixer.num_mixes));
+        log_info("Software mixer maximum microseconds per mix:", 0,
+            (int) (mixer.max_mix_ticks * 1000000 / frequency));
+    }
+    thread_mutex_unlock(mixer.mutex);
+    thread_mutex_destroy(mixer.mutex);
+    memset(&mixer, 0, sizeof(mixer));
+}
+
+static void stop_all_voices(void)
+{
+    if (mixer.enabled) {
+        thread_mutex_lock(mixer.mutex);
+        for (int i = 0; i < MAX_CHANNELS; i++) {
+            mixer.voices[i].chunk = 0;
+        }
+        thread_mutex_unlock(mixer.mutex);
+    }
+}
+
+static void play_chunk(int channel, Mix_Chunk *chunk)
+{
+    if (mixer.enabled) {
+        thread_mutex_lock(mixer.mutex);
+        mixer.voices[channel].chunk = chunk;
+        mixer.voices[channel].position = 0;
+        thread_mutex_unlock(mixer.mutex);
+    } else {
+        Mix_PlayChannel(channel, chunk, 0);
+    }
+}
+
+static void init_channels(void)
+{
+    data.initialized = 1;
+    memset(data.channels, 0, sizeof(data.channels));
+    start_mixer();
 }
 
 void sound_device_open(void)
@@ -111,12 +301,22 @@ void sound_device_open(void)
     }
 }
 
+static void free_samples(void);
+static void stop_prefetch(void);
+
 void sound_device_close(void)
 {
     if (data.initialized) {
         for (int i = 0; i < MAX_CHANNELS; i++) {
             sound_device_stop_channel(i);
+            if (data.channels[i].file_chunk) {
+                Mix_FreeChunk(data.channels[i].file_chunk);
+            }
         }
+        stop_mixer();
+        free_samples();
+        stop_prefetch();
+        memset(data.channels, 0, sizeof(data.channels));
         Mix_CloseAudio();
         data.initialized = 0;
     }
@@ -140,12 +340,83 @@ static Mix_Chunk *load_chunk(const char *filename)
     }
 }
 
-static int load_channel(sound_channel *channel)
+static void lock_pool(void)
+{
+    if (pool.mutex) {
+        thread_mutex_lock(pool.mutex);
+    }
+}
+
+static void unlock_pool(void)
+{
+    if (pool.mutex) {
+        thread_mutex_unlock(pool.mutex);
+    }
+}
+
+static int load_samples(void *unused)
+{
+    // samples are in channel order, so the interface and effect sounds are ready first
+    for (int i = 0; i < pool.num_samples; i++) {
+        lock_pool();
+        int stop = pool.stop_loading;
+        unlock_pool();
+        if (stop) {
+            break;
+        }
+        Mix_Chunk *chunk = load_chunk(pool.samples[i].filename);
+        lock_pool();
+        pool.samples[i].chunk = chunk;
+        unlock_pool();
+    }
+    log_info("Audio files loaded:", 0, pool.num_samples);
+    return 0;
+}
+
+static void free_samples(void)
 {
-    if (!channel->chunk && channel->filename) {
-        channel->chunk = load_chunk(channel->filename);
+    if (pool.loader) {
+        lock_pool();
+        pool.stop_loading = 1;
+        unlock_pool();
+        thread_wait(pool.loader);
+        pool.loader = 0;
+    }
+    for (int i = 0; i < pool.num_samples; i++) {
+        if (pool.samples[i].chunk) {
+            Mix_FreeChunk(pool.samples[i].chunk);
+        }
+    }
+    if (pool.mutex) {
+        thread_mutex_destroy(pool.mutex);
+        pool.mutex = 0;
     }
-    return channel->chunk ? 1 : 0;
+    memset(&pool, 0, sizeof(pool));
+}
+
+static sound_sample *get_sample(const char *filename)
+{
+    for (int i = 0; i < pool.num_samples; i++) {
+        if (strcmp(pool.samples[i].filename, filename) == 0) {
+            return &pool.samples[i];
+        }
+    }
+    sound_sample *sample = &pool.samples[pool.num_samples++];
+    sample->filename = filename;
+    sample->chunk = 0;
+    return sample;
+}
+
+static Mix_Chunk *get_channel_chunk(sound_channel *channel)
+{
+    if (!channel->sample) {
+        return 0;
+    }
+    // a sample that is still being loaded is skipped rather than loaded during the frame
+    lock_pool();
+    Mix_Chunk *chunk = channel->sample->chunk;
+    unlock_pool();
+    return chunk;
 }
 
 void sound_device_init_channels(int num_channels, char filenames[][CHANNEL_FILENAME_MAX])
@@ -154,18 +425,36 @@ void sound_device_init_channels(int num_channels, char filenames[][CHANNEL_FILEN
         if (num_channels > MAX_CHANNELS) {
             num_channels = MAX_CHANNELS;
         }
-        Mix_AllocateChannels(num_channels);
+        // the software mixer plays all channels itself: SDL_mixer would only loop over idle channels
+        Mix_AllocateChannels(mixer.enabled ? 0 : num_channels);
         log_info("Loading audio files", 0, 0);
+        stop_all_voices();
+        free_samples();
         for (int i = 0; i < num_channels; i++) {
-            data.channels[i].chunk = 0;
-            data.channels[i].filename = filenames[i][0] ? filenames[i] : 0;
+            data.channels[i].sample = filenames[i][0] ? get_sample(filenames[i]) : 0;
+        }
+        pool.mutex = thread_mutex_create();
+        if (pool.mutex) {
+            pool.loader = thread_create(load_samples, "sound loader", 0);
+        }
+        if (!pool.loader) {
+            load_samples(0);
         }
     }
 }
 
 int sound_device_is_channel_playing(int channel)
 {
-    return data.channels[channel].chunk && Mix_Playing(channel);
+    if (!data.channels[channel].playing) {
+        return 0;
+    }
+    if (mixer.enabled) {
+        thread_mutex_lock(mixer.mutex);
+        int playing = mixer.voices[channel].chunk != 0;
+        thread_mutex_unlock(mixer.mutex);
+        return playing;
+    }
+    return Mix_Playing(channel);
 }
 
 void sound_device_set_music_volume(int volume_pct)
@@ -175,8 +464,13 @@ void sound_device_set_music_volume(int volume_pct)
 
 void sound_device_set_channel_volume(int channel, int volume_pct)
 {
-    if (data.channels[channel].chunk) {
-        Mix_VolumeChunk(data.channels[channel].chunk, percentage_to_volume(volume_pct));
+    // the volume is set on the channel because chunks are shared between channels
+    if (mixer.enabled) {
+        thread_mutex_lock(mixer.mutex);
+        mixer.voices[channel].volume = percentage_to_volume(volume_pct);
+        thread_mutex_unlock(mixer.mutex);
+    } else {
+        Mix_Volume(channel, percentage_to_volume(volume_pct));
     }
 }
 
@@ -203,6 +497,158 @@ static void load_music_for_vita(const char *filename)
 }
 #endif
 
+#ifndef __vita__
+static Mix_Music *load_music(const char *filename)
+{
+#ifdef __ANDROID__
+    FILE *fp = file_open(filename, "rb");
+    if (!fp) {
+        return 0;
+    }
+    SDL_RWops *sdl_fp = SDL_RWFromFP(fp, SDL_TRUE);
+    return Mix_LoadMUSType_RW(sdl_fp, file_has_extension(filename, "mp3") ? MUS_MP3 : MUS_WAV, SDL_TRUE);
+#else
+    return Mix_LoadMUS(filename);
+#endif
+}
+
+static int prefetch_music(void *unused)
+{
+    thread_mutex_lock(prefetch.mutex);
+    while (!prefetch.stop) {
+        prefetched_music *track = 0;
+        for (int i = 0; i < MAX_PREFETCHED_MUSIC; i++) {
+            if (prefetch.tracks[i].state == PREFETCH_QUEUED) {
+                track = &prefetch.tracks[i];
+                break;
+            }
+        }
+        if (!track) {
+            thread_condition_wait(prefetch.condition, prefetch.mutex);
+            continue;
+        }
+        // a track that is loading is never replaced, so its filename stays valid while unlocked
+        track->state = PREFETCH_LOADING;
+        thread_mutex_unlock(prefetch.mutex);
+        Mix_Music *music = load_music(track->filename);
+        thread_mutex_lock(prefetch.mutex);
+        track->music = music;
+        track->state = PREFETCH_READY;
+        thread_condition_broadcast(prefetch.condition);
+    }
+    thread_mutex_unlock(prefetch.mutex);
+    return 0;
+}
+
+static int start_prefetch(void)
+{
+    prefetch.mutex = thread_mutex_create();
+    prefetch.condition = thread_condition_create();
+    if (prefetch.mutex && prefetch.condition) {
+        prefetch.loader = thread_create(prefetch_music, "music loader", 0);
+    }
+    if (!prefetch.loader) {
+        stop_prefetch();
+        return 0;
+    }
+    return 1;
+}
+
+static int take_prefetched_music(const char *filename, Mix_Music **music)
+{
+    if (!prefetch.loader) {
+        return 0;
+    }
+    int found = 0;
+    thread_mutex_lock(prefetch.mutex);
+    for (int i = 0; i < MAX_PREFETCHED_MUSIC; i++) {
+        prefetched_music *track = &prefetch.tracks[i];
+        if (track->state == PREFETCH_NONE || strcmp(track->filename, filename) != 0) {
+            continue;
+        }
+        // waiting for a track that is already loading is never slower than loading it again
+        while (track->state == PREFETCH_LOADING) {
+            thread_condition_wait(prefetch.condition, prefetch.mutex);
+        }
+        if (track->state == PREFETCH_READY) {
+            *music = track->music;
+            found = 1;
+        }
+        track->music = 0;
+        track->filename[0] = 0;
+        track->state = PREFETCH_NONE;
+        break;
+    }
+    thread_mutex_unlock(prefetch.mutex);
+    return found;
+}
+#endif
+
+static void stop_prefetch(void)
+{
+    if (prefetch.loader) {
+        thread_mutex_lock(prefetch.mutex);
+        prefetch.stop = 1;
+        thread_condition_broadcast(prefetch.condition);
+        thread_mutex_unlock(prefetch.mutex);
+        thread_wait(prefetch.loader);
+    }
+    for (int i = 0; i < MAX_PREFETCHED_MUSIC; i++) {
+        if (prefetch.tracks[i].music) {
+            Mix_FreeMusic(prefetch.tracks[i].music);
+        }
+    }
+    if (prefetch.condition) {
+        thread_condition_destroy(prefetch.condition);
+    }
+    if (prefetch.mutex) {
+        thread_mutex_destroy(prefetch.mutex);
+    }
+    memset(&prefetch, 0, sizeof(prefetch));
+}
+
+void sound_device_prefetch_music(const char *filename)
+{
+#ifndef __vita__
+    // not on Vita: it keeps only the music file that is playing in memory
+    if (!data.initialized || !filename || strlen(filename) >= FILE_NAME_MAX) {
+        return;
+    }
+    if (!prefetch.loader && !start_prefetch()) {
+        return;
+    }
+    thread_mutex_lock(prefetch.mutex);
+    prefetched_music *track = 0;
+    for (int i = 0; i < MAX_PREFETCHED_MUSIC; i++) {
+        prefetched_music *current = &prefetch.tracks[i];
+        if (current->state != PREFETCH_NONE && strcmp(current->filename, filename) == 0) {
+            thread_mutex_unlock(prefetch.mutex);
+            return;
+        }
+        if (!track && current->state == PREFETCH_NONE) {
+            track = current;
+        }
+    }
+    for (int i = 0; i < MAX_PREFETCHED_MUSIC && !track; i++) {
+        prefetched_music *current = &prefetch.tracks[(prefetch.next_replace + i) % MAX_PREFETCHED_MUSIC];
+        if (current->state != PREFETCH_LOADING) {
+            track = current;
+        }
+    }
+    if (track) {
+        if (track->music) {
+            Mix_FreeMusic(track->music);
+            track->music = 0;
+        }
+        strcpy(track->filename, filename);
+        track->state = PREFETCH_QUEUED;
+        prefetch.next_replace = (int) (track - prefetch.tracks + 1) % MAX_PREFETCHED_MUSIC;
+        thread_condition_signal(prefetch.condition);
+    }
+    thread_mutex_unlock(prefetch.mutex);
+#endif
+}
+
 int sound_device_play_music(const char *filename, int volume_pct)
 {
     if (data.initialized) {
@@ -217,15 +663,10 @@ int sound_device_play_music(const char *filename, int volume_pct)
         }
         SDL_RWops *sdl_music = SDL_RWFromMem(vita_music_data.buffer, vita_music_data.size);
         data.music = Mix_LoadMUSType_RW(sdl_music, file_has_extension(filename, "mp3") ? MUS_MP3 : MUS_WAV, SDL_TRUE);
-#elif defined(__ANDROID__)
-        FILE *fp = file_open(filename, "rb");
-        if (!fp) {
-            return 0;
-        }
-        SDL_RWops *sdl_fp = SDL_RWFromFP(fp, SDL_TRUE);
-        data.music = Mix_LoadMUSType_RW(sdl_fp, file_has_extension(filename, "mp3") ? MUS_MP3 : MUS_WAV, SDL_TRUE);
 #else
-        data.music = Mix_LoadMUS(filename);
+        if (!take_prefetched_music(filename, &data.music)) {
+            data.music = load_music(filename);
+        }
 #endif
         if (!data.music) {
             SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,
@@ -248,10 +689,19 @@ void sound_device_play_file_on_channel(const char *filename, int channel, int vo
 {
     if (data.initialized) {
         sound_device_stop_channel(channel);
-        data.channels[channel].chunk = load_chunk(filename);
-        if (data.channels[channel].chunk) {
+        sound_channel *ch = &data.channels[channel];
+        // the last file is kept, so playing the same file again does not read it again
+        if (!ch->file_chunk || strcmp(ch->file, filename) != 0) {
+            if (ch->file_chunk) {
+                Mix_FreeChunk(ch->file_chunk);
+            }
+            ch->file_chunk = load_chunk(filename);
+            strncpy(ch->file, filename, FILE_NAME_MAX - 1);
+        }
+        if (ch->file_chunk) {
             sound_device_set_channel_volume(channel, volume_pct);
-            Mix_PlayChannel(channel, data.channels[channel].chunk, 0);
+            play_chunk(channel, ch->file_chunk);
+            ch->playing = ch->file_chunk;
         }
     }
 }
@@ -260,9 +710,11 @@ void sound_device_play_channel(int channel, int volume_pct)
 {
     if (data.initialized) {
         sound_channel *ch = &data.channels[channel];
-        if (load_channel(ch)) {
+        Mix_Chunk *chunk = get_channel_chunk(ch);
+        if (chunk) {
             sound_device_set_channel_volume(channel, volume_pct);
-            Mix_PlayChannel(channel, ch->chunk, 0);
+            play_chunk(channel, chunk);
+            ch->playing = chunk;
         }
     }
 }
@@ -271,10 +723,19 @@ void sound_device_play_channel_panned(int channel, int volume_pct, int left_pct,
 {
     if (data.initialized) {
         sound_channel *ch = &data.channels[channel];
-        if (load_channel(ch)) {
-            Mix_SetPanning(channel, left_pct * 255 / 100, right_pct * 255 / 100);
+        Mix_Chunk *chunk = get_channel_chunk(ch);
+        if (chunk) {
+            if (mixer.enabled) {
+                thread_mutex_lock(mixer.mutex);
+                mixer.voices[channel].left = left_pct * 255 / 100;
+                mixer.voices[channel].right = right_pct * 255 / 100;
+                thread_mutex_unlock(mixer.mutex);
+            } else {
+                Mix_SetPanning(channel, left_pct * 255 / 100, right_pct * 255 / 100);
+            }
             sound_device_set_channel_volume(channel, volume_pct);
-            Mix_PlayChannel(channel, ch->chunk, 0);
+            play_chunk(channel, chunk);
+            ch->playing = chunk;
         }
     }
 }
@@ -294,10 +755,15 @@ void sound_device_stop_channel(int channel)
 {
     if (data.initialized) {
         sound_channel *ch = &data.channels[channel];
-        if (ch->chunk) {
-            Mix_HaltChannel(channel);
-            Mix_FreeChunk(ch->chunk);
-            ch->chunk = 0;
+        if (ch->playing) {
+            if (mixer.enabled) {
+                thread_mutex_lock(mixer.mutex);
+                mixer.voices[channel].chunk = 0;
+                thread_mutex_unlock(mixer.mutex);
+            } else {
+                Mix_HaltChannel(channel);
+            }
+            ch->playing = 0;
         }
     }
 }
@@ -0,0 +1,78 @@
+#include "core/thread.h"
+
+#include "SDL.h"
+
+thread *thread_create(thread_function *func, const char *name, void *data)
+{
+    return (thread *) SDL_CreateThread(func, name, data);
+}
+
+int thread_wait(thread *t)
+{
+    int result = 0;
+    SDL_WaitThread((SDL_Thread *) t, &result);
+    return result;
+}
+
+int thread_cpu_count(void)
+{
+    int count = SDL_GetCPUCount();
+    return count > 0 ? count : 1;
+}
+
+thread_mutex *thread_mutex_create(void)
+{
+    return (thread_mutex *) SDL_CreateMutex();
+}
+
+void thread_mutex_lock(thread_mutex *mutex)
+{
+    if (mutex) {
+        SDL_LockMutex((SDL_mutex *) mutex);
+    }
+}
+
+void thread_mutex_unlock(thread_mutex *mutex)
+{
+    if (mutex) {
+        SDL_UnlockMutex((SDL_mutex *) mutex);
+    }
+}
+
+void thread_mutex_destroy(thread_mutex *mutex)
+{
+    if (mutex) {
+        SDL_DestroyMutex((SDL_mutex *) mutex);
+    }
+}
+
+thread_condition *thread_condition_create(void)
+{
+    return (thread_condition *) SDL_CreateCond();
+}
+
+void thread_condition_wait(thread_condition *condition, thread_mutex *mutex)
+{
+    SDL_CondWait((SDL_cond *) condition, (SDL_mutex *) mutex);
+}
+
+void thread_condition_signal(thread_condition *condition)
+{
+    if (condition) {
+        SDL_CondSignal((SDL_cond *) condition);
+    }
+}
+
+void thread_condition_broadcast(thread_condition *condition)
+{
+    if (condition) {
+        SDL_CondBroadcast((SDL_cond *) condition);
+    }
+}
+
+void thread_condition_destroy(thread_condition *condition)
+{
+    if (condition) {
+        SDL_DestroyCond((SDL_cond *) condition);
+    }
+}
@@ -13,6 +13,14 @@ void sound_device_set_music_volume(int volume_pct);
 void sound_device_set_channel_volume(int channel, int volume_pct);
 
 int sound_device_play_music(const char *filename, int volume_pct);
+
+/**
+ * Opens a music file on a background thread, so that a later sound_device_play_music()
+ * with the same file starts without waiting for the file. Only the last two files are kept.
+ * @param filename Music file that is likely to be played next
+ */
+void sound_device_prefetch_music(const char *filename);
+
 void sound_device_play_file_on_channel(const char *filename, int channel, int volume_pct);
 void sound_device_play_channel(int channel, int volume_pct);
 void sound_device_play_channel_panned(int channel, int volume_pct, int left_pct, int right_pct);
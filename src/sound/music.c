@@ -82,6 +82,34 @@ void sound_music_play_editor(void)
     }
 }
 
+static void prefetch_track(int track)
+{
+    if (track < TRACK_CITY_1 || track > TRACK_CITY_5) {
+        return;
+    }
+    const char *filename = dir_get_file(mp3_tracks[track], NOT_LOCALIZED);
+    if (!filename) {
+        filename = dir_get_file(tracks[track], NOT_LOCALIZED);
+    }
+    sound_device_prefetch_music(filename);
+}
+
+static int get_city_track(void)
+{
+    int population = city_population();
+    if (population < 1000) {
+        return TRACK_CITY_1;
+    } else if (population < 2000) {
+        return TRACK_CITY_2;
+    } else if (population < 5000) {
+        return TRACK_CITY_3;
+    } else if (population < 7000) {
+        return TRACK_CITY_4;
+    } else {
+        return TRACK_CITY_5;
+    }
+}
+
 void sound_music_update(int force)
 {
     if (data.next_check && !force) {
@@ -92,22 +120,14 @@ void sound_music_update(int force)
         return;
     }
     int track;
-    int population = city_population();
+    int city_track = get_city_track();
     int total_enemies = city_figures_total_invading_enemies();
     if (total_enemies >= 32) {
         track = TRACK_COMBAT_LONG;
     } else if (total_enemies > 0) {
         track = TRACK_COMBAT_SHORT;
-    } else if (population < 1000) {
-        track = TRACK_CITY_1;
-    } else if (population < 2000) {
-        track = TRACK_CITY_2;
-    } else if (population < 5000) {
-        track = TRACK_CITY_3;
-    } else if (population < 7000) {
-        track = TRACK_CITY_4;
     } else {
-        track = TRACK_CITY_5;
+        track = city_track;
     }
 
     if (track == data.current_track) {
@@ -116,6 +136,15 @@ void sound_music_update(int force)
 
     play_track(track);
     data.next_check = 10;
+
+    // open the tracks that are likely to come next: after a battle the city track returns,
+    // otherwise the population slowly moves to one of the neighbouring city tracks
+    if (track == city_track) {
+        prefetch_track(city_track + 1);
+        prefetch_track(city_track - 1);
+    } else {
+        prefetch_track(city_track);
+    }
 }
 
 void sound_music_stop(void)
@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Zobrazit velikost konstrukce při přetahování"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Zvýraznit legii při najetí kurzorem"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Povolit vojenský postranní panel"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Zobrazit překryvy jako barevná pole místo sloupců"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Opravit chybu imigrace na velmi těžkou obtížnost"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Opravit chybu stoletých duchů"},
+    {TR_CONFIG_COMPACT_SAVES, "Ukládat hry v kompaktním formátu (nečitelné pro Caesar 3)"},
     {TR_HOTKEY_TITLE, "Nastavení klávesových zkratek Julia"},
     {TR_HOTKEY_LABEL, "Klávesa"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternativní"},
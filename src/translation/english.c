@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Show draggable construction size"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Highlight legion on cursor hover"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Enable military sidebar"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Show overlays as colored tiles instead of columns"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Fix immigration bug on very hard"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Fix 100-year-old ghosts"},
+    {TR_CONFIG_COMPACT_SAVES, "Save games in compact format (not readable by Caesar 3)"},
     {TR_HOTKEY_TITLE, "Julius hotkey configuration"},
     {TR_HOTKEY_LABEL, "Hotkey"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternative"},
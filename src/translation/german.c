@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Zeige Konstruktionsgröße beim Bauen"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Hebe Soldaten bei Berührung mit der Maus hervor"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Zeige Legionen am rechten Bildschirmrand"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Zeige Überlagerungen als farbige Felder statt Säulen"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Behebe Immigrationsfehler auf 'Sehr schwierig'"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Behebe '100 Jahre alte Geister'"},
+    {TR_CONFIG_COMPACT_SAVES, "Spielstände im kompakten Format speichern (nicht lesbar für Caesar 3)"},
     {TR_HOTKEY_TITLE, "Julius Tastenkombinationen einstellen"},
     {TR_HOTKEY_LABEL, "Tastenkombination"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternativ"},
@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Mostra le dimensioni della costruzione durante il trascinamento"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Evidenzia la legione al passaggio del cursore"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Abilita il pannello militare"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Mostra le sovrapposizioni come caselle colorate invece di colonne"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Correggi il bug dell'immigrazione al livello molto difficile"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Corregge il bug dei centenari"},
+    {TR_CONFIG_COMPACT_SAVES, "Salva le partite in formato compatto (non leggibile da Caesar 3)"},
     {TR_HOTKEY_TITLE, "Configurazione delle scorciatoie da tastiera"},
     {TR_HOTKEY_LABEL, "Tasto"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternativa"},
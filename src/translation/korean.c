@@ -47,8 +47,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "드래그 건설 시 전체 크기 표시"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "커서가 올라간 군단 강조"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "군단 제어판 사용"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "오버레이를 기둥 대신 색상 타일로 표시"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "매우 어려움 난이도 이민 버그 수정"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "100세 이상 고령 주민 문제 수정"},
+    {TR_CONFIG_COMPACT_SAVES, "압축 형식으로 게임 저장 (Caesar 3에서 읽을 수 없음)"},
     {TR_HOTKEY_TITLE, "Julius 단축키 설정"},
     {TR_HOTKEY_LABEL, "단축키"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "대체"},
@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Pokaż rozmiar budowy przy przeciąganiu kursorem"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Podświetl legion przy najechaniu kursorem"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Włącz boczny panel wojskowy"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Pokazuj nakładki jako kolorowe pola zamiast kolumn"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Napraw błąd z imigracją na najwyższym poziomie trudności"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Napraw 100-letnie duchy"},
+    {TR_CONFIG_COMPACT_SAVES, "Zapisuj gry w formacie kompaktowym (nieczytelnym dla Caesar 3)"},
     {TR_HOTKEY_TITLE, "Julius - konfiguracja skrótów klawiszowych"},
     {TR_HOTKEY_LABEL, "Skrót klawiszowy"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternatywny"},
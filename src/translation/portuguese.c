@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Mostrar o tamanho da construção ao arrastar"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Realçar legiões focadas pelo mouse"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Mostrar barra lateral militar"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Mostrar camadas como blocos coloridos em vez de colunas"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Consertar falha durante a imigração na dificuldade máxima"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Consertar falha dos 'fantasmas' de 100 anos"},
+    {TR_CONFIG_COMPACT_SAVES, "Salvar jogos em formato compacto (não legível pelo Caesar 3)"},
     {TR_HOTKEY_TITLE, "Configurações de teclas de atalho do Julius"},
     {TR_HOTKEY_LABEL, "Tecla de atalho"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternativa"},
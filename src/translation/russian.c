@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Показывать область при групповой стройке зданий"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Подсвечивать легион под курсором"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Отображать боковую панель армии"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Показывать слои цветными клетками вместо столбиков"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Исправить баг иммиграции в режиме \"Очень сложный\""},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Исправить баг 100-летних жителей"},
+    {TR_CONFIG_COMPACT_SAVES, "Сохранять игры в компактном формате (не читается Caesar 3)"},
     {TR_HOTKEY_TITLE, "Горячие клавиши Julius"},
     {TR_HOTKEY_LABEL, "Горячие клавиши"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Альтернативные"},
@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "显示拖动建设大小"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "鼠标悬停时高亮军团"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "显示军队信息侧栏"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "以彩色地块代替柱状图显示图层"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "修复非常困难不来人BUG"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "修复人口百岁仍占房BUG"},
+    {TR_CONFIG_COMPACT_SAVES, "以紧凑格式存档（凯撒3无法读取）"},
     {TR_HOTKEY_TITLE, "Julius 热键绑定"},
     {TR_HOTKEY_LABEL, "热键"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "可替代键"},
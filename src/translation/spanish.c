@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Mostrar medidas de construcción al arrastrar"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Resaltar legión bajo el cursor"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Activar barra militar lateral"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Mostrar capas como casillas de colores en lugar de columnas"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Corregir bug impidiendo inmigración en Muy Difícil"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Corregir bug creando fantasmas con 100 años"},
+    {TR_CONFIG_COMPACT_SAVES, "Guardar partidas en formato compacto (no legible por Caesar 3)"},
     {TR_HOTKEY_TITLE, "Configuración de atajos de teclado de Julius"},
     {TR_HOTKEY_LABEL, "Principal"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Secundario"},
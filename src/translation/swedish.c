@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "Visa dragbar byggnadsstorlek"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "Framhäv legion när muspekaren är över den"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "Använd militärsidopanelen"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "Visa överlägg som färgade rutor i stället för staplar"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "Fixa invandringsproblem med svårighetsgraden Väldigt Svårt"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "Fixa 100-års spöken"},
+    {TR_CONFIG_COMPACT_SAVES, "Spara spel i kompakt format (kan inte läsas av Caesar 3)"},
     {TR_HOTKEY_TITLE, "Julius kortkommandon"},
     {TR_HOTKEY_LABEL, "Kortkommando"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "Alternativ"},
@@ -46,8 +46,10 @@ static translation_string all_strings[] = {
     {TR_CONFIG_SHOW_CONSTRUCTION_SIZE, "顯示拖動建設大小"},
     {TR_CONFIG_HIGHLIGHT_LEGIONS, "滑鼠懸停時高亮軍團"},
     {TR_CONFIG_SHOW_MILITARY_SIDEBAR, "顯示軍隊資訊側欄"},
+    {TR_CONFIG_OVERLAY_HEATMAP, "以彩色地塊代替柱狀圖顯示圖層"},
     {TR_CONFIG_FIX_IMMIGRATION_BUG, "修復非常困難不來人BUG"},
     {TR_CONFIG_FIX_100_YEAR_GHOSTS, "修復人口百歲仍占房BUG"},
+    {TR_CONFIG_COMPACT_SAVES, "以緊湊格式存檔（凱撒3無法讀取）"},
     {TR_HOTKEY_TITLE, "Julius 熱鍵綁定"},
     {TR_HOTKEY_LABEL, "熱鍵"},
     {TR_HOTKEY_ALTERNATIVE_LABEL, "可替代鍵"},
@@ -38,8 +38,10 @@ typedef enum {
     TR_CONFIG_SHOW_CONSTRUCTION_SIZE,
     TR_CONFIG_HIGHLIGHT_LEGIONS,
     TR_CONFIG_SHOW_MILITARY_SIDEBAR,
+    TR_CONFIG_OVERLAY_HEATMAP,
     TR_CONFIG_FIX_IMMIGRATION_BUG,
     TR_CONFIG_FIX_100_YEAR_GHOSTS,
+    TR_CONFIG_COMPACT_SAVES,
     TR_HOTKEY_TITLE,
     TR_HOTKEY_LABEL,
     TR_HOTKEY_ALTERNATIVE_LABEL,
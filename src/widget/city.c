@@ -236,6 +236,7 @@ static void build_end(void)
         }
         building_construction_place();
         widget_minimap_invalidate();
+        city_with_overlay_invalidate();
     }
 }
 
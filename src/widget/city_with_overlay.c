@@ -8,6 +8,7 @@
 #include "core/log.h"
 #include "game/resource.h"
 #include "game/state.h"
+#include "game/time.h"
 #include "graphics/image.h"
 #include "map/bridge.h"
 #include "map/building.h"
@@ -28,8 +29,17 @@
 #include "widget/city_overlay_risks.h"
 #include "widget/city_without_overlay.h"
 
+#include <string.h>
+
 static const city_overlay *overlay = 0;
 
+static struct {
+    int overlay_type;
+    int day;
+    int is_valid;
+    grid_i8 column_height;
+} values;
+
 #define OFFSET(x,y) (x + GRID_SIZE * y)
 
 static const int ADJACENT_OFFSETS[2][4][7] = {
@@ -109,11 +119,59 @@ static int select_city_overlay(void)
     return overlay != 0;
 }
 
+static int current_day(void)
+{
+    return (game_time_year() * 12 + game_time_month()) * 16 + game_time_day();
+}
+
+static int get_column_height_at(int grid_offset)
+{
+    int building_id = map_building_at(grid_offset);
+    if (!building_id || !map_terrain_is(grid_offset, TERRAIN_BUILDING)) {
+        return NO_COLUMN;
+    }
+    const building *b = building_get(building_id);
+    if (overlay->show_building(b)) {
+        return NO_COLUMN;
+    }
+    int height = overlay->get_column_height(b);
+    if (height > 10) {
+        height = 10;
+    }
+    return height;
+}
+
+static void update_values(void)
+{
+    int day = current_day();
+    if (values.is_valid && values.overlay_type == overlay->type && values.day == day) {
+        return;
+    }
+    values.overlay_type = overlay->type;
+    values.day = day;
+    values.is_valid = 1;
+
+    int width, height;
+    map_grid_size(&width, &height);
+    memset(values.column_height.items, NO_COLUMN, sizeof(values.column_height.items));
+    for (int y = 0; y < height; y++) {
+        int grid_offset = map_grid_offset(0, y);
+        for (int x = 0; x < width; x++, grid_offset++) {
+            values.column_height.items[grid_offset] = get_column_height_at(grid_offset);
+        }
+    }
+}
+
 void city_with_overlay_update(void)
 {
     select_city_overlay();
 }
 
+void city_with_overlay_invalidate(void)
+{
+    values.is_valid = 0;
+}
+
 static int is_drawable_farmhouse(int grid_offset, int map_orientation)
 {
     if (!map_property_is_draw_tile(grid_offset)) {
@@ -378,8 +436,8 @@ void city_with_overlay_draw_building_top(int x, int y, int grid_offset)
     }
     if (overlay->show_building(b)) {
         draw_building_top(grid_offset, b, x, y);
-    } else {
-        int column_height = overlay->get_column_height(b);
+    } else if (!config_get(CONFIG_UI_OVERLAY_HEATMAP)) {
+        int column_height = values.column_height.items[grid_offset];
         if (column_height != NO_COLUMN) {
             int draw = 1;
             if (building_is_farm(b->type)) {
@@ -412,6 +470,31 @@ static void draw_top(int x, int y, int grid_offset)
     }
 }
 
+static color_t get_heatmap_color(int column_height)
+{
+    int red, green, blue;
+    if (overlay->column_type == COLUMN_TYPE_RISK) {
+        // yellow for low risk to red for high risk
+        red = 0xff;
+        green = 0xff * (10 - column_height) / 10;
+        blue = 0;
+    } else {
+        // red for no access to blue for full access
+        red = 0xff * (10 - column_height) / 10;
+        green = 0x33;
+        blue = 0xff * column_height / 10;
+    }
+    return ALPHA_MASK_SEMI_TRANSPARENT | red << 16 | green << 8 | blue;
+}
+
+static void draw_heatmap_tile(int x, int y, int grid_offset)
+{
+    int column_height = values.column_height.items[grid_offset];
+    if (column_height != NO_COLUMN) {
+        image_draw_blend_alpha(image_group(GROUP_TERRAIN_FLAT_TILE), x, y, get_heatmap_color(column_height));
+    }
+}
+
 static void draw_animation(int x, int y, int grid_offset)
 {
     int draw = 0;
@@ -544,8 +627,12 @@ void city_with_overlay_draw(const map_tile *tile)
         return;
     }
 
+    update_values();
     int should_mark_deleting = city_building_ghost_mark_deleting(tile);
     city_view_foreach_map_tile(draw_footprint);
+    if (config_get(CONFIG_UI_OVERLAY_HEATMAP) && !overlay->draw_custom_footprint) {
+        city_view_foreach_valid_map_tile(draw_heatmap_tile);
+    }
     if (!should_mark_deleting) {
         city_view_foreach_valid_map_tile_row(
             draw_figures,
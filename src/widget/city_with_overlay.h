@@ -9,6 +9,11 @@
  */
 void city_with_overlay_update(void);
 
+/**
+ * Recalculate the overlay values on the next draw, e.g. after construction or when buildings are destroyed
+ */
+void city_with_overlay_invalidate(void);
+
 void city_with_overlay_draw(const map_tile *tile);
 
 int city_with_overlay_get_tooltip_text(tooltip_context *c, int grid_offset);
@@ -15,6 +15,7 @@
 #include "scenario/property.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 enum {
     FIGURE_COLOR_NONE = 0,
@@ -24,10 +25,20 @@ enum {
     FIGURE_COLOR_WOLF = 4
 };
 
+#define MAP_MARGIN 8
+#define MAP_BITMAP_WIDTH (2 * VIEW_X_MAX + 2 * MAP_MARGIN)
+#define MAP_BITMAP_HEIGHT (VIEW_Y_MAX + 2 * MAP_MARGIN)
+
+#define TILE_KEY_FIGURE 0x80000000
+#define TILE_KEY_BUILDING_PART 0x40000000
+
+#define FIGURE_TILE_BEFORE 1
+#define FIGURE_TILE_NOW 2
+
 enum {
     REFRESH_NOT_NEEDED = 0,
-    REFRESH_FULL = 1,
-    REFRESH_CAMERA_MOVED = 2
+    REFRESH_TILES = 1,
+    REFRESH_DRAW = 2
 };
 
 static const color_t ENEMY_COLOR_BY_CLIMATE[] = {
@@ -46,7 +57,17 @@ static struct {
     int width;
     int height;
     color_t enemy_color;
-    color_t *cache;
+    int climate;
+    struct {
+        color_t *pixels;
+        uint32_t *tile_keys;
+        int *tile_offsets; // grid offset of every tile at the last update, changes with the orientation
+        uint32_t row_signatures[GRID_SIZE];
+        uint8_t dirty_rows[GRID_SIZE];
+        uint8_t figure_tiles[GRID_SIZE * GRID_SIZE]; // FIGURE_TILE_* flags
+        uint8_t redraw_building[MAX_BUILDINGS];
+        int num_redraw_buildings;
+    } map;
     struct {
         int x;
         int y;
@@ -123,7 +144,7 @@ static int has_figure_color(figure *f)
     return FIGURE_COLOR_NONE;
 }
 
-static int draw_figure(int x_view, int y_view, int grid_offset)
+static uint32_t get_figure_key(int grid_offset)
 {
     int color_type = map_figure_foreach_until(grid_offset, has_figure_color);
     if (color_type == FIGURE_COLOR_NONE) {
@@ -137,19 +158,28 @@ static int draw_figure(int x_view, int y_view, int grid_offset)
     } else if (color_type == FIGURE_COLOR_ENEMY) {
         color = data.enemy_color;
     }
-    graphics_draw_horizontal_line(x_view, x_view + 1, y_view, color);
-    return 1;
+    return TILE_KEY_FIGURE | color;
+}
+
+static uint32_t image_key(int image_id, int size)
+{
+    return (uint32_t) image_id << 3 | size;
 }
 
-static void draw_minimap_tile(int x_view, int y_view, int grid_offset)
+/**
+ * Calculates a key that uniquely identifies what the minimap shows for a tile:
+ * a figure color, a building image with its size, a part of a building that is drawn
+ * by another tile, or a terrain image
+ */
+static uint32_t get_tile_key(int grid_offset)
 {
     if (grid_offset < 0) {
-        image_draw(image_group(GROUP_MINIMAP_BLACK), x_view, y_view);
-        return;
+        return image_key(image_group(GROUP_MINIMAP_BLACK), 0);
     }
 
-    if (draw_figure(x_view, y_view, grid_offset)) {
-        return;
+    uint32_t figure_key = get_figure_key(grid_offset);
+    if (figure_key) {
+        return figure_key;
     }
 
     int terrain = map_terrain_get(grid_offset);
@@ -161,24 +191,23 @@ static void draw_minimap_tile(int x_view, int y_view, int grid_offset)
     }
 
     if (terrain & TERRAIN_BUILDING) {
-        if (map_property_is_draw_tile(grid_offset)) {
-            int image_id;
-            building *b = building_get(map_building_at(grid_offset));
-            if (b->house_size) {
-                image_id = image_group(GROUP_MINIMAP_HOUSE);
-            } else if (b->type == BUILDING_RESERVOIR) {
-                image_id = image_group(GROUP_MINIMAP_AQUEDUCT) - 1;
-            } else {
-                image_id = image_group(GROUP_MINIMAP_BUILDING);
-            }
-            switch (map_property_multi_tile_size(grid_offset)) {
-                case 1: image_draw(image_id, x_view, y_view); break;
-                case 2: image_draw(image_id + 1, x_view, y_view - 1); break;
-                case 3: image_draw(image_id + 2, x_view, y_view - 2); break;
-                case 4: image_draw(image_id + 3, x_view, y_view - 3); break;
-                case 5: image_draw(image_id + 4, x_view, y_view - 4); break;
-            }
+        if (!map_property_is_draw_tile(grid_offset)) {
+            return TILE_KEY_BUILDING_PART | map_building_at(grid_offset);
         }
+        int image_id;
+        building *b = building_get(map_building_at(grid_offset));
+        if (b->house_size) {
+            image_id = image_group(GROUP_MINIMAP_HOUSE);
+        } else if (b->type == BUILDING_RESERVOIR) {
+            image_id = image_group(GROUP_MINIMAP_AQUEDUCT) - 1;
+        } else {
+            image_id = image_group(GROUP_MINIMAP_BUILDING);
+        }
+        int size = map_property_multi_tile_size(grid_offset);
+        if (size < 1 || size > 5) {
+            return TILE_KEY_BUILDING_PART | map_building_at(grid_offset);
+        }
+        return image_key(image_id, size);
     } else {
         int rand = map_random_get(grid_offset);
         int image_id;
@@ -199,8 +228,172 @@ static void draw_minimap_tile(int x_view, int y_view, int grid_offset)
         } else {
             image_id = image_group(GROUP_MINIMAP_EMPTY_LAND) + (rand & 7);
         }
-        image_draw(image_id, x_view, y_view);
+        return image_key(image_id, 1);
+    }
+}
+
+static void draw_tile_from_key(int x, int y, uint32_t key)
+{
+    if (key & TILE_KEY_FIGURE) {
+        graphics_draw_horizontal_line(x, x + 1, y, key & ~TILE_KEY_FIGURE);
+        return;
+    }
+    if (key & TILE_KEY_BUILDING_PART) {
+        // drawn by the building's draw tile
+        return;
+    }
+    int image_id = key >> 3;
+    int size = key & 7;
+    if (size > 1) {
+        image_draw(image_id + size - 1, x, y - size + 1);
+    } else {
+        image_draw(image_id, x, y);
+    }
+}
+
+static int allocate_map_bitmap(void)
+{
+    data.map.pixels = (color_t *) malloc(sizeof(color_t) * MAP_BITMAP_WIDTH * MAP_BITMAP_HEIGHT);
+    data.map.tile_keys = (uint32_t *) malloc(sizeof(uint32_t) * VIEW_X_MAX * VIEW_Y_MAX);
+    data.map.tile_offsets = (int *) malloc(sizeof(int) * VIEW_X_MAX * VIEW_Y_MAX);
+    if (!data.map.pixels || !data.map.tile_keys || !data.map.tile_offsets) {
+        free(data.map.pixels);
+        free(data.map.tile_keys);
+        free(data.map.tile_offsets);
+        data.map.pixels = 0;
+        data.map.tile_keys = 0;
+        data.map.tile_offsets = 0;
+        return 0;
+    }
+    // force a full redraw on the first update
+    data.climate = -1;
+    return 1;
+}
+
+static void clear_map_bitmap(void)
+{
+    memset(data.map.pixels, 0, sizeof(color_t) * MAP_BITMAP_WIDTH * MAP_BITMAP_HEIGHT);
+    // 0xffffffff is never a valid key and -1 never a stored offset, so every tile is redrawn on the next update
+    memset(data.map.tile_keys, 0xff, sizeof(uint32_t) * VIEW_X_MAX * VIEW_Y_MAX);
+    for (int i = 0; i < VIEW_X_MAX * VIEW_Y_MAX; i++) {
+        data.map.tile_offsets[i] = -2;
+    }
+}
+
+static uint32_t hash_value(uint32_t hash, uint32_t value)
+{
+    return (hash ^ value) * 16777619u;
+}
+
+/**
+ * Marks the map rows in which the terrain or a building changed since the last update
+ */
+static void find_dirty_rows(void)
+{
+    for (int y = 0; y < GRID_SIZE; y++) {
+        uint32_t hash = 2166136261u;
+        for (int grid_offset = y * GRID_SIZE; grid_offset < (y + 1) * GRID_SIZE; grid_offset++) {
+            hash = hash_value(hash, map_terrain_get(grid_offset));
+            int building_id = map_building_at(grid_offset);
+            if (building_id) {
+                const building *b = building_get(building_id);
+                hash = hash_value(hash, building_id);
+                hash = hash_value(hash, b->type << 8 | b->house_size);
+                hash = hash_value(hash, map_property_multi_tile_size(grid_offset) << 1 |
+                    map_property_is_draw_tile(grid_offset));
+            }
+        }
+        data.map.dirty_rows[y] = hash != data.map.row_signatures[y];
+        data.map.row_signatures[y] = hash;
+    }
+}
+
+/**
+ * Marks the tiles that show a figure now, in addition to the ones that showed a figure at the last update
+ */
+static void find_figure_tiles(void)
+{
+    for (int i = 1; i < MAX_FIGURES; i++) {
+        figure *f = figure_get(i);
+        if (f->state == FIGURE_STATE_ALIVE && map_grid_is_valid_offset(f->grid_offset) && has_figure_color(f)) {
+            data.map.figure_tiles[f->grid_offset] |= FIGURE_TILE_NOW;
+        }
+    }
+}
+
+static void finish_figure_tiles(void)
+{
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+        data.map.figure_tiles[i] = data.map.figure_tiles[i] & FIGURE_TILE_NOW ? FIGURE_TILE_BEFORE : 0;
+    }
+}
+
+static int is_tile_dirty(int grid_offset)
+{
+    if (data.map.dirty_rows[grid_offset / GRID_SIZE] || data.map.figure_tiles[grid_offset]) {
+        return 1;
+    }
+    // a part of a building changed in an earlier row, so its draw tile has to be drawn again
+    return data.map.num_redraw_buildings > 0 && data.map.redraw_building[map_building_at(grid_offset)];
+}
+
+static void update_map_tile(int x_view, int y_view, int grid_offset)
+{
+    int y_abs = y_view - MAP_MARGIN;
+    int x_abs = (x_view - MAP_MARGIN + (y_abs & 1)) / 2;
+    int *stored_offset = &data.map.tile_offsets[y_abs * VIEW_X_MAX + x_abs];
+    if (*stored_offset == grid_offset && (grid_offset < 0 || !is_tile_dirty(grid_offset))) {
+        return;
+    }
+    *stored_offset = grid_offset;
+    uint32_t *stored_key = &data.map.tile_keys[y_abs * VIEW_X_MAX + x_abs];
+    uint32_t key = get_tile_key(grid_offset);
+    int building_id = 0;
+    if (grid_offset >= 0 && map_terrain_is(grid_offset, TERRAIN_BUILDING)) {
+        building_id = map_building_at(grid_offset);
+    }
+    if (key == *stored_key) {
+        if (!building_id || !data.map.redraw_building[building_id] || !map_property_is_draw_tile(grid_offset)) {
+            return;
+        }
+    } else if (building_id && !map_property_is_draw_tile(grid_offset)) {
+        // The draw tile comes later in drawing order and paints over this tile
+        if (!data.map.redraw_building[building_id]) {
+            data.map.redraw_building[building_id] = 1;
+            data.map.num_redraw_buildings++;
+        }
     }
+    if (building_id && map_property_is_draw_tile(grid_offset) && data.map.redraw_building[building_id]) {
+        data.map.redraw_building[building_id] = 0;
+        data.map.num_redraw_buildings--;
+    }
+    *stored_key = key;
+    draw_tile_from_key(x_view, y_view, key);
+}
+
+/**
+ * Brings the map-space bitmap up to date. Only the tiles in rows that changed, the tiles
+ * with figures and the tiles that moved because of a rotation are looked at again,
+ * and of those only the ones whose contents changed are redrawn.
+ */
+static void update_map_bitmap(void)
+{
+    int climate = scenario_property_climate();
+    if (climate != data.climate) {
+        data.climate = climate;
+        clear_map_bitmap();
+    }
+    data.enemy_color = ENEMY_COLOR_BY_CLIMATE[climate];
+    memset(data.map.redraw_building, 0, sizeof(data.map.redraw_building));
+    data.map.num_redraw_buildings = 0;
+    find_dirty_rows();
+    find_figure_tiles();
+
+    graphics_set_custom_canvas(data.map.pixels, MAP_BITMAP_WIDTH, MAP_BITMAP_HEIGHT);
+    city_view_foreach_minimap_tile(MAP_MARGIN, MAP_MARGIN, 0, 0, VIEW_X_MAX, VIEW_Y_MAX - 4, update_map_tile);
+    graphics_restore_screen_canvas();
+
+    finish_figure_tiles();
 }
 
 static void draw_viewport_rectangle(void)
@@ -226,67 +419,69 @@ static void draw_viewport_rectangle(void)
         COLOR_MINIMAP_VIEWPORT);
 }
 
-static void prepare_minimap_cache(int width, int height)
+static void draw_from_map_bitmap(void)
 {
-    if (width != data.width || height != data.height) {
-        free(data.cache);
-        data.cache = (color_t *)malloc(sizeof(color_t) * width * height);
+    const clip_info *clip = graphics_get_clip_info(data.x_offset, data.y_offset, data.width, data.height);
+    if (!clip->is_visible) {
+        return;
+    }
+    int x_start = data.x_offset + clip->clipped_pixels_left;
+    int x_end = x_start + clip->visible_pixels_x;
+    int y_start = data.y_offset + clip->clipped_pixels_top;
+    int y_end = data.y_offset + data.height - clip->clipped_pixels_bottom;
+    // map-space position of the minimap's top-left pixel
+    int map_x = MAP_MARGIN + 2 * data.absolute_x - data.x_offset;
+    int map_y = MAP_MARGIN + data.absolute_y - data.y_offset;
+    for (int y = y_start; y < y_end; y++) {
+        color_t *dst = graphics_get_pixel(x_start, y);
+        int src_y = map_y + y;
+        if (src_y < 0 || src_y >= MAP_BITMAP_HEIGHT) {
+            memset(dst, 0, sizeof(color_t) * (x_end - x_start));
+            continue;
+        }
+        const color_t *src_row = &data.map.pixels[src_y * MAP_BITMAP_WIDTH];
+        int x = x_start;
+        for (; x < x_end && map_x + x < 0; x++) {
+            *dst++ = COLOR_BLACK;
+        }
+        int copy_end = x_end;
+        if (map_x + copy_end > MAP_BITMAP_WIDTH) {
+            copy_end = MAP_BITMAP_WIDTH - map_x;
+        }
+        if (copy_end > x) {
+            memcpy(dst, &src_row[map_x + x], sizeof(color_t) * (copy_end - x));
+            dst += copy_end - x;
+            x = copy_end;
+        }
+        for (; x < x_end; x++) {
+            *dst++ = COLOR_BLACK;
+        }
     }
 }
 
-static void cache_minimap(void)
-{
-    graphics_save_to_buffer(data.x_offset, data.y_offset, data.width, data.height, data.cache);
-}
-
-static void draw_minimap(void)
-{
-    graphics_set_clip_rectangle(data.x_offset, data.y_offset, data.width, data.height);
-    foreach_map_tile(draw_minimap_tile);
-    cache_minimap();
-    draw_viewport_rectangle();
-    graphics_reset_clip_rectangle();
-}
-
-static void draw_uncached(int x_offset, int y_offset, int width, int height)
-{
-    data.enemy_color = ENEMY_COLOR_BY_CLIMATE[scenario_property_climate()];
-    prepare_minimap_cache(width, height);
-    set_bounds(x_offset, y_offset, width, height);
-    draw_minimap();
-}
-
-static void draw_using_cache(int x_offset, int y_offset, int width, int height)
+static void draw_minimap(int x_offset, int y_offset, int width, int height)
 {
-    if (width != data.width || height != data.height || x_offset != data.x_offset) {
-        draw_uncached(x_offset, y_offset, width, height);
-        return;
-    }
-
-    int old_absolute_x = data.absolute_x;
-    int old_absolute_y = data.absolute_y;
     set_bounds(x_offset, y_offset, width, height);
-    if (data.absolute_x != old_absolute_x || data.absolute_y != old_absolute_y) {
-        draw_minimap();
-        return;
-    }
-
-    graphics_set_clip_rectangle(x_offset, y_offset, width, height);
-    graphics_draw_from_buffer(x_offset, y_offset, data.width, data.height, data.cache);
+    graphics_set_clip_rectangle(data.x_offset, data.y_offset, data.width, data.height);
+    draw_from_map_bitmap();
     draw_viewport_rectangle();
     graphics_reset_clip_rectangle();
 }
 
 static int should_refresh(int force)
 {
-    if (data.refresh_requested || force) {
+    if (data.refresh_requested) {
         data.refresh_requested = 0;
-        return REFRESH_FULL;
+        return REFRESH_TILES;
+    }
+    if (force) {
+        // the sidebar was redrawn: the bitmap is still up to date
+        return REFRESH_DRAW;
     }
     int new_x, new_y;
     city_view_get_camera(&new_x, &new_y);
     if (data.camera_x != new_x || data.camera_y != new_y) {
-        return REFRESH_CAMERA_MOVED;
+        return REFRESH_DRAW;
     }
     return REFRESH_NOT_NEEDED;
 }
@@ -294,17 +489,23 @@ static int should_refresh(int force)
 void widget_minimap_draw(int x_offset, int y_offset, int width, int height, int force)
 {
     int refresh_type = should_refresh(force);
-    if (refresh_type != REFRESH_NOT_NEEDED) {
-        if (refresh_type == REFRESH_FULL) {
-            draw_uncached(x_offset, y_offset, width, height);
-        } else {
-            draw_using_cache(x_offset, y_offset, width, height);
+    if (refresh_type == REFRESH_NOT_NEEDED) {
+        return;
+    }
+    if (!data.map.pixels) {
+        if (!allocate_map_bitmap()) {
+            return;
         }
-        graphics_draw_horizontal_line(x_offset - 1, x_offset - 1 + width, y_offset - 1, COLOR_MINIMAP_DARK);
-        graphics_draw_vertical_line(x_offset - 1, y_offset, y_offset + height, COLOR_MINIMAP_DARK);
-        graphics_draw_vertical_line(x_offset - 1 + width, y_offset,
-            y_offset + height, COLOR_MINIMAP_LIGHT);
+        refresh_type = REFRESH_TILES;
+    }
+    if (refresh_type == REFRESH_TILES) {
+        update_map_bitmap();
     }
+    draw_minimap(x_offset, y_offset, width, height);
+    graphics_draw_horizontal_line(x_offset - 1, x_offset - 1 + width, y_offset - 1, COLOR_MINIMAP_DARK);
+    graphics_draw_vertical_line(x_offset - 1, y_offset, y_offset + height, COLOR_MINIMAP_DARK);
+    graphics_draw_vertical_line(x_offset - 1 + width, y_offset,
+        y_offset + height, COLOR_MINIMAP_LIGHT);
 }
 
 static void update_mouse_grid_offset(int x_view, int y_view, int grid_offset)
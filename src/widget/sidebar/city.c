@@ -18,6 +18,7 @@
 #include "map/orientation.h"
 #include "scenario/property.h"
 #include "widget/city.h"
+#include "widget/city_with_overlay.h"
 #include "widget/minimap.h"
 #include "widget/sidebar/common.h"
 #include "widget/sidebar/extra.h"
@@ -295,6 +296,7 @@ static void button_undo(int param1, int param2)
 {
     window_build_menu_hide();
     game_undo_perform();
+    city_with_overlay_invalidate();
     window_invalidate();
 }
 
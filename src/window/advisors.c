@@ -133,6 +133,14 @@ static void init(void)
     city_ratings_update_explanations();
 
     set_advisor_window();
+
+    int images[] = {
+        image_group(GROUP_ADVISOR_BACKGROUND),
+        image_group(GROUP_PANEL_WINDOWS) + 13,
+        image_group(GROUP_PANEL_WINDOWS) + 14,
+        image_group(GROUP_PANEL_WINDOWS) + 15
+    };
+    image_prefetch_external(images, 4);
 }
 
 void window_advisors_draw_dialog_background(void)
@@ -353,6 +353,7 @@ void window_city_show(void)
         handle_input,
         get_tooltip
     };
+    city_with_overlay_invalidate();
     window_show(&window);
 }
 
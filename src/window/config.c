@@ -116,10 +116,12 @@ static config_widget all_widgets[MAX_WIDGETS] = {
     {TYPE_CHECKBOX, CONFIG_UI_SHOW_CONSTRUCTION_SIZE, TR_CONFIG_SHOW_CONSTRUCTION_SIZE},
     {TYPE_CHECKBOX, CONFIG_UI_HIGHLIGHT_LEGIONS, TR_CONFIG_HIGHLIGHT_LEGIONS},
     {TYPE_CHECKBOX, CONFIG_UI_SHOW_MILITARY_SIDEBAR, TR_CONFIG_SHOW_MILITARY_SIDEBAR},
+    {TYPE_CHECKBOX, CONFIG_UI_OVERLAY_HEATMAP, TR_CONFIG_OVERLAY_HEATMAP},
     {TYPE_SPACE},
     {TYPE_HEADER, 0, TR_CONFIG_HEADER_GAMEPLAY_CHANGES},
     {TYPE_CHECKBOX, CONFIG_GP_FIX_IMMIGRATION_BUG, TR_CONFIG_FIX_IMMIGRATION_BUG},
-    {TYPE_CHECKBOX, CONFIG_GP_FIX_100_YEAR_GHOSTS, TR_CONFIG_FIX_100_YEAR_GHOSTS}
+    {TYPE_CHECKBOX, CONFIG_GP_FIX_100_YEAR_GHOSTS, TR_CONFIG_FIX_100_YEAR_GHOSTS},
+    {TYPE_CHECKBOX, CONFIG_GP_COMPACT_SAVES, TR_CONFIG_COMPACT_SAVES}
 };
 
 static generic_button select_buttons[] = {
@@ -25,10 +25,32 @@
 #include "window/city.h"
 #include "window/editor/map.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #define NUM_FILES_IN_VIEW 12
 #define MAX_FILE_WINDOW_TEXT_WIDTH (18 * BLOCK_SIZE)
+#define PREVIEW_Y 380
+#define PREVIEW_TEXT_X 224
+#define PREVIEW_TEXT_WIDTH 272
+
+enum {
+    PREVIEW_UNKNOWN = 0,
+    PREVIEW_NONE = 1,
+    PREVIEW_LOADED = 2
+};
+
+static const color_t THUMBNAIL_COLORS[SAVEGAME_THUMBNAIL_MAX] = {
+    0x6b8442, // land
+    0x214a18, // tree
+    0x8c7b63, // rock
+    0x3163a5, // water
+    0x9c9484, // road
+    0xd6cebd, // wall
+    0x63a5d6, // aqueduct
+    0xce9452, // house
+    0xa54231 // building
+};
 
 static const time_millis NOT_EXIST_MESSAGE_TIMEOUT = 500;
 
@@ -62,6 +84,11 @@ typedef struct {
     char last_loaded_file[FILE_NAME_MAX];
 } file_type_data;
 
+typedef struct {
+    int state;
+    savegame_info *info;
+} savegame_preview;
+
 static struct {
     time_millis message_not_exist_start_time;
     file_type type;
@@ -74,6 +101,14 @@ static struct {
     uint8_t typed_name[FILE_NAME_MAX];
     uint8_t previously_seen_typed_name[FILE_NAME_MAX];
     char selected_file[FILE_NAME_MAX];
+    int selected_index;
+
+    struct {
+        savegame_preview *files; // one for every file in file_list, read when first shown
+        int num_files;
+        int thumbnail_index;
+        color_t thumbnail[SAVEGAME_THUMBNAIL_SIZE * SAVEGAME_THUMBNAIL_SIZE];
+    } preview;
 } data;
 
 static input_box file_name_input = {144, 80, 20, 2, FONT_NORMAL_WHITE, 0, data.typed_name, FILE_NAME_MAX};
@@ -119,6 +154,53 @@ static void scroll_to_typed_text(void)
     }
 }
 
+static int find_file_index(const char *filename)
+{
+    for (int i = 0; i < data.file_list->num_files; i++) {
+        if (strcmp(data.file_list->files[i], filename) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void init_previews(void)
+{
+    for (int i = 0; i < data.preview.num_files; i++) {
+        free(data.preview.files[i].info);
+    }
+    free(data.preview.files);
+    data.preview.files = 0;
+    data.preview.num_files = 0;
+    data.preview.thumbnail_index = -1;
+    if (data.type != FILE_TYPE_SAVED_GAME || data.file_list->num_files <= 0) {
+        return;
+    }
+    data.preview.files = (savegame_preview *) calloc(data.file_list->num_files, sizeof(savegame_preview));
+    if (data.preview.files) {
+        data.preview.num_files = data.file_list->num_files;
+    }
+}
+
+static const savegame_info *get_preview(int index)
+{
+    if (index < 0 || index >= data.preview.num_files) {
+        return 0;
+    }
+    savegame_preview *preview = &data.preview.files[index];
+    if (preview->state == PREVIEW_UNKNOWN) {
+        preview->state = PREVIEW_NONE;
+        preview->info = (savegame_info *) malloc(sizeof(savegame_info));
+        if (preview->info && game_file_read_saved_game_info(data.file_list->files[index], preview->info)) {
+            preview->state = PREVIEW_LOADED;
+        } else {
+            free(preview->info);
+            preview->info = 0;
+        }
+    }
+    return preview->info;
+}
+
 static void init(file_type type, file_dialog_type dialog_type)
 {
     data.type = type;
@@ -146,9 +228,53 @@ static void init(file_type type, file_dialog_type dialog_type)
     scroll_to_typed_text();
 
     strncpy(data.selected_file, data.file_data->last_loaded_file, FILE_NAME_MAX);
+    data.selected_index = find_file_index(data.selected_file);
+    init_previews();
     input_box_start(&file_name_input);
 }
 
+static void draw_preview(void)
+{
+    int index = data.selected_index;
+    if (data.focus_button_id) {
+        index = scrollbar.scroll_position + data.focus_button_id - 1;
+    }
+    const savegame_info *info = get_preview(index);
+    if (!info) {
+        return;
+    }
+    if (data.preview.thumbnail_index != index) {
+        for (int i = 0; i < SAVEGAME_THUMBNAIL_SIZE * SAVEGAME_THUMBNAIL_SIZE; i++) {
+            data.preview.thumbnail[i] = THUMBNAIL_COLORS[info->thumbnail[i]];
+        }
+        data.preview.thumbnail_index = index;
+    }
+    outer_panel_draw(128, PREVIEW_Y, 24, 6);
+    graphics_draw_from_buffer(144, PREVIEW_Y + 16, SAVEGAME_THUMBNAIL_SIZE, SAVEGAME_THUMBNAIL_SIZE,
+        data.preview.thumbnail);
+    graphics_draw_inset_rect(143, PREVIEW_Y + 15, SAVEGAME_THUMBNAIL_SIZE + 2, SAVEGAME_THUMBNAIL_SIZE + 2);
+
+    const uint8_t *name = info->scenario_name[0] ? info->scenario_name : info->player_name;
+    text_draw_ellipsized(name, PREVIEW_TEXT_X, PREVIEW_Y + 12, PREVIEW_TEXT_WIDTH, FONT_NORMAL_BLACK, 0);
+    lang_text_draw_month_year_max_width(info->month, info->year,
+        PREVIEW_TEXT_X, PREVIEW_Y + 29, PREVIEW_TEXT_WIDTH, FONT_NORMAL_BLACK, 0);
+
+    int half_width = PREVIEW_TEXT_WIDTH / 2;
+    int width = lang_text_draw(6, 0, PREVIEW_TEXT_X, PREVIEW_Y + 46, FONT_NORMAL_BLACK);
+    text_draw_number(info->treasury, '@', " ", PREVIEW_TEXT_X + width, PREVIEW_Y + 46, FONT_NORMAL_BLACK);
+    width = lang_text_draw(6, 1, PREVIEW_TEXT_X + half_width, PREVIEW_Y + 46, FONT_NORMAL_BLACK);
+    text_draw_number(info->population, '@', " ", PREVIEW_TEXT_X + half_width + width, PREVIEW_Y + 46,
+        FONT_NORMAL_BLACK);
+
+    const int ratings[4] = {info->culture, info->prosperity, info->peace, info->favor};
+    for (int i = 0; i < 4; i++) {
+        int x = PREVIEW_TEXT_X + (i % 2) * half_width;
+        int y = PREVIEW_Y + 63 + (i / 2) * 17;
+        width = lang_text_draw(53, i + 1, x, y, FONT_NORMAL_BLACK);
+        text_draw_number(ratings[i], '@', " ", x + width, y, FONT_NORMAL_BLACK);
+    }
+}
+
 static void draw_foreground(void)
 {
     graphics_in_dialog();
@@ -184,9 +310,22 @@ static void draw_foreground(void)
     image_buttons_draw(0, 0, image_buttons, 2);
     scrollbar_draw(&scrollbar);
 
+    draw_preview();
+
     graphics_reset_dialog();
 }
 
+static void select_typed_file(void)
+{
+    char typed_file[FILE_NAME_MAX];
+    encoding_to_utf8(data.typed_name, typed_file, FILE_NAME_MAX, encoding_system_uses_decomposed());
+    file_append_extension(typed_file, data.file_data->extension);
+    data.selected_index = find_file_index(typed_file);
+    if (data.selected_index >= 0) {
+        strncpy(data.selected_file, typed_file, FILE_NAME_MAX - 1);
+    }
+}
+
 static int should_scroll_to_typed_text(void)
 {
     if (string_equals(data.previously_seen_typed_name, data.typed_name)) {
@@ -223,6 +362,10 @@ static void handle_input(const mouse *m, const hotkeys *h)
         window_go_back();
     }
 
+    if (!string_equals(data.previously_seen_typed_name, data.typed_name)) {
+        // Show the preview of the file with the typed name, if any
+        select_typed_file();
+    }
     if (should_scroll_to_typed_text()) {
         scroll_to_typed_text();
     }
@@ -291,6 +434,8 @@ static void button_ok_cancel(int is_ok, int param2)
     } else if (data.dialog_type == FILE_DIALOG_DELETE) {
         if (game_file_delete_saved_game(filename)) {
             dir_find_files_with_extension(data.file_data->extension);
+            data.selected_index = -1;
+            init_previews();
             if (scrollbar.scroll_position + NUM_FILES_IN_VIEW >= data.file_list->num_files) {
                 --scrollbar.scroll_position;
             }
@@ -312,6 +457,7 @@ static void button_select_file(int index, int param2)
 {
     if (index < data.file_list->num_files) {
         strncpy(data.selected_file, data.file_list->files[scrollbar.scroll_position + index], FILE_NAME_MAX - 1);
+        data.selected_index = scrollbar.scroll_position + index;
         encoding_from_utf8(data.selected_file, data.typed_name, FILE_NAME_MAX);
         file_remove_extension(data.typed_name);
         string_copy(data.typed_name, data.previously_seen_typed_name, FILE_NAME_MAX);
@@ -166,5 +166,10 @@ void window_mission_selection_show(void)
     };
     data.choice = 0;
     data.focus_button = 0;
+    int images[] = {
+        image_group(GROUP_SELECT_MISSION_BACKGROUND),
+        image_group(GROUP_SELECT_MISSION) + BACKGROUND_IMAGE_OFFSET[scenario_campaign_rank()]
+    };
+    image_prefetch_external(images, 2);
     window_show(&window);
 }
@@ -0,0 +1,98 @@
+#include "../src/graphics/scaler.h"
+
+#include <stdio.h>
+
+#define ALPHA 0xff000000
+#define T COLOR_SG2_TRANSPARENT
+
+// each pixel has its column in red and its row in green
+static const color_t PATTERN[4 * 4] = {
+    0x000010, 0x400010, 0x800010, 0xc00010,
+    0x004010, 0x404010, 0x804010, 0xc04010,
+    0x008010, 0x408010, 0x808010, 0xc08010,
+    0x00c010, 0x40c010, 0x80c010, 0xc0c010
+};
+
+static const color_t PARTLY_TRANSPARENT[4 * 2] = {
+    T, T, T, 0x102030,
+    T, 0x204060, 0x304050, 0x203040
+};
+
+static int check_pixels(const char *name, const color_t *actual, const color_t *expected, int num_pixels)
+{
+    int errors = 0;
+    for (int i = 0; i < num_pixels; i++) {
+        if (actual[i] != expected[i]) {
+            printf("ERROR: %s: pixel %d is %08x, expected %08x\n",
+                name, i, (unsigned int) actual[i], (unsigned int) expected[i]);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+static int check_scale(const char *name, scaler_mode mode, const color_t *src, int src_stride,
+    int src_width, int src_height, int dst_width, int dst_height, const color_t *expected)
+{
+    scaler s = {0};
+    color_t dst[4 * 4];
+    if (!scaler_set_size(&s, mode, src_width, src_height, dst_width, dst_height)) {
+        printf("ERROR: %s: unable to prepare the scaler\n", name);
+        return 1;
+    }
+    scaler_draw(&s, src, src_stride, dst, dst_width, 0, 0, dst_width, dst_height, ALPHA);
+    scaler_free(&s);
+    return check_pixels(name, dst, expected, dst_width * dst_height);
+}
+
+static int check_part(void)
+{
+    // only the bottom right quarter is drawn, the rest of the destination is untouched
+    static const color_t expected[4 * 4] = {
+        0, 0, 0, 0,
+        0, 0, 0, 0,
+        0, 0, ALPHA | 0x808010, ALPHA | 0xc08010,
+        0, 0, ALPHA | 0x80c010, ALPHA | 0xc0c010
+    };
+    scaler s = {0};
+    color_t dst[4 * 4] = {0};
+    if (!scaler_set_size(&s, SCALER_NEAREST, 4, 4, 4, 4)) {
+        printf("ERROR: part: unable to prepare the scaler\n");
+        return 1;
+    }
+    scaler_draw(&s, PATTERN, 4, &dst[2 * 4 + 2], 4, 2, 2, 2, 2, ALPHA);
+    scaler_free(&s);
+    return check_pixels("part", dst, expected, 4 * 4);
+}
+
+int main(int argc, char **argv)
+{
+    static const color_t nearest_down[2 * 2] = {
+        ALPHA | 0x404010, ALPHA | 0xc04010,
+        ALPHA | 0x40c010, ALPHA | 0xc0c010
+    };
+    static const color_t nearest_up[4 * 4] = {
+        ALPHA | 0x000010, ALPHA | 0x000010, ALPHA | 0x400010, ALPHA | 0x400010,
+        ALPHA | 0x000010, ALPHA | 0x000010, ALPHA | 0x400010, ALPHA | 0x400010,
+        ALPHA | 0x004010, ALPHA | 0x004010, ALPHA | 0x404010, ALPHA | 0x404010,
+        ALPHA | 0x004010, ALPHA | 0x004010, ALPHA | 0x404010, ALPHA | 0x404010
+    };
+    static const color_t average_down[2 * 2] = {
+        ALPHA | 0x202010, ALPHA | 0xa02010,
+        ALPHA | 0x20a010, ALPHA | 0xa0a010
+    };
+    static const color_t average_transparent[2] = {
+        ALPHA | T, ALPHA | 0x203040
+    };
+    int errors = 0;
+    errors += check_scale("nearest down", SCALER_NEAREST, PATTERN, 4, 4, 4, 2, 2, nearest_down);
+    errors += check_scale("nearest up", SCALER_NEAREST, PATTERN, 4, 2, 2, 4, 4, nearest_up);
+    errors += check_scale("average down", SCALER_AVERAGE, PATTERN, 4, 4, 4, 2, 2, average_down);
+    errors += check_scale("average transparent", SCALER_AVERAGE, PARTLY_TRANSPARENT, 4, 4, 2, 2, 1,
+        average_transparent);
+    errors += check_part();
+    if (!errors) {
+        printf("All scaled pixels match\n");
+    }
+    return errors ? 1 : 0;
+}
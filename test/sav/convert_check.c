@@ -0,0 +1,59 @@
+#include "sav_compare.h"
+
+#include "game/file_io.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define FILE_NAME_MAX 300
+
+static long file_size(const char *filename)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        return 0;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+static int check_file(const char *filename)
+{
+    char compact[FILE_NAME_MAX];
+    char legacy[FILE_NAME_MAX];
+    snprintf(compact, FILE_NAME_MAX, "%s-compact.sav", filename);
+    snprintf(legacy, FILE_NAME_MAX, "%s-legacy.sav", filename);
+
+    if (!game_file_io_convert_saved_game(filename, compact, 1)) {
+        printf("ERROR: unable to convert %s to the compact format\n", filename);
+        return 1;
+    }
+    if (!game_file_io_convert_saved_game(compact, legacy, 0)) {
+        printf("ERROR: unable to convert %s back to the original format\n", compact);
+        return 1;
+    }
+    if (compare_files(filename, legacy) != 0) {
+        printf("ERROR: %s changed after converting to the compact format and back\n", filename);
+        return 1;
+    }
+    long original_size = file_size(filename);
+    long compact_size = file_size(compact);
+    printf("%s: %ld bytes, compact %ld bytes (%.2f%%)\n", filename, original_size, compact_size,
+        original_size ? 100.0 * compact_size / original_size : 0.0);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Usage: convertcheck <sav file>...\n");
+        return -1;
+    }
+    int errors = 0;
+    for (int i = 1; i < argc; i++) {
+        errors += check_file(argv[i]);
+    }
+    return errors ? 1 : 0;
+}
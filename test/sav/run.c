@@ -2,6 +2,7 @@
 #include "core/time.h"
 #include "game/file.h"
 #include "game/game.h"
+#include "game/replay.h"
 #include "game/settings.h"
 
 #ifdef _MSC_VER
@@ -34,7 +35,8 @@ static void run_ticks(int ticks)
     }
 }
 
-static int run_autopilot(const char *input_saved_game, const char *output_saved_game, int ticks_to_run)
+static int run_autopilot(const char *input_saved_game, const char *output_saved_game, int ticks_to_run,
+    const char *replay_file)
 {
     printf("Running autopilot: %s --> %s in %d ticks\n", input_saved_game, output_saved_game, ticks_to_run);
     signal(SIGSEGV, handler);
@@ -58,7 +60,15 @@ static int run_autopilot(const char *input_saved_game, const char *output_saved_
         }
         return 3;
     }
+    if (replay_file && !replay_load(replay_file)) {
+        printf("Unable to load replay %s\n", replay_file);
+        return 4;
+    }
     run_ticks(ticks_to_run);
+    if (replay_errors()) {
+        printf("Replay went out of sync %d times\n", replay_errors());
+        return 5;
+    }
     printf("Saving game to %s\n", output_saved_game);
     game_file_write_saved_game(output_saved_game);
     printf("Done\n");
@@ -70,7 +80,7 @@ static int run_autopilot(const char *input_saved_game, const char *output_saved_
 
 int main(int argc, char **argv)
 {
-    if (argc != 5) {
+    if (argc != 5 && argc != 6) {
         printf("Incorrect number of arguments (%d)\n", argc);
         return -1;
     }
@@ -78,7 +88,8 @@ int main(int argc, char **argv)
     const char *output = argv[2];
     const char *expected = argv[3];
     int ticks = atoi(argv[4]);
-    if (run_autopilot(input, output, ticks) == 0) {
+    const char *replay = argc == 6 ? argv[5] : 0;
+    if (run_autopilot(input, output, ticks, replay) == 0) {
         return compare_files(expected, output);
     } else {
         return 1;
@@ -322,6 +322,33 @@ static int unpack(const char *filename, unsigned char *buffer)
     return offset;
 }
 
+int get_savegame_part(int index, const char **name, int *length, int *record_length)
+{
+    if (index < 0 || index >= (int) (sizeof(save_game_parts) / sizeof(struct game_file_part)) - 1) {
+        return 0;
+    }
+    *name = save_game_parts[index].name;
+    *length = save_game_parts[index].length_in_bytes;
+    *record_length = save_game_parts[index].record_length;
+    return 1;
+}
+
+int for_each_compressed_part(const char *filename, compressed_part_callback *callback)
+{
+    int length = unpack(filename, file1_data);
+    if (!length) {
+        return 0;
+    }
+    int offset = 0;
+    for (int i = 0; save_game_parts[i].length_in_bytes; i++) {
+        if (save_game_parts[i].compressed) {
+            callback(save_game_parts[i].name, &file1_data[offset], save_game_parts[i].length_in_bytes);
+        }
+        offset += save_game_parts[i].length_in_bytes;
+    }
+    return 1;
+}
+
 static int has_adjacent_terrain_type(int part_offset, int terrain_type)
 {
     int grid_offset = part_offset / 2;
@@ -3,4 +3,10 @@
 
 int compare_files(const char *file1, const char *file2);
 
+int get_savegame_part(int index, const char **name, int *length, int *record_length);
+
+typedef void (compressed_part_callback)(const char *name, const unsigned char *data, int length);
+
+int for_each_compressed_part(const char *filename, compressed_part_callback *callback);
+
 #endif // SAV_COMPARE_H
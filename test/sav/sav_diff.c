@@ -0,0 +1,484 @@
+#include "sav_compare.h"
+
+#include "core/parallel.h"
+#include "game/file_io.h"
+#include "map/grid.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PIECES 300
+#define MAX_CHANGES_PER_PIECE 100
+#define RECORD_SIZE 128
+
+typedef struct {
+    const char *name;
+    int size;
+    int is_signed;
+} record_field;
+
+// field layout of building_state_save_to_buffer()
+static const record_field BUILDING_FIELDS[] = {
+    {"state", 1, 0},
+    {"faction_id", 1, 0},
+    {"unknown_value", 1, 0},
+    {"size", 1, 0},
+    {"house_is_merged", 1, 0},
+    {"house_size", 1, 0},
+    {"x", 1, 0},
+    {"y", 1, 0},
+    {"grid_offset", 2, 1},
+    {"type", 2, 1},
+    {"subtype", 2, 1},
+    {"road_network_id", 1, 0},
+    {"unused_0f", 1, 0},
+    {"created_sequence", 2, 0},
+    {"houses_covered", 2, 1},
+    {"percentage_houses_covered", 2, 1},
+    {"house_population", 2, 1},
+    {"house_population_room", 2, 1},
+    {"distance_from_entry", 2, 1},
+    {"house_highest_population", 2, 1},
+    {"house_unreachable_ticks", 2, 1},
+    {"road_access_x", 1, 0},
+    {"road_access_y", 1, 0},
+    {"figure_id", 2, 1},
+    {"figure_id2", 2, 1},
+    {"immigrant_figure_id", 2, 1},
+    {"figure_id4", 2, 1},
+    {"figure_spawn_delay", 1, 0},
+    {"unused_2b", 1, 0},
+    {"figure_roam_direction", 1, 0},
+    {"has_water_access", 1, 0},
+    {"unused_2e", 1, 0},
+    {"unused_2f", 1, 0},
+    {"prev_part_building_id", 2, 1},
+    {"next_part_building_id", 2, 1},
+    {"loads_stored", 2, 1},
+    {"unused_36", 1, 0},
+    {"has_well_access", 1, 0},
+    {"num_workers", 2, 1},
+    {"labor_category", 1, 0},
+    {"output_resource_id", 1, 0},
+    {"has_road_access", 1, 0},
+    {"house_criminal_active", 1, 0},
+    {"damage_risk", 2, 1},
+    {"fire_risk", 2, 1},
+    {"fire_duration", 2, 1},
+    {"fire_proof", 1, 0},
+    {"house_figure_generation_delay", 1, 0},
+    {"house_tax_coverage", 1, 0},
+    {"unused_47", 1, 0},
+    {"formation_id", 2, 1},
+    {"type_data", 42, 0},
+    {"tax_income_or_storage", 4, 1},
+    {"house_days_without_food", 1, 0},
+    {"ruin_has_plague", 1, 0},
+    {"desirability", 1, 1},
+    {"is_deleted", 1, 0},
+    {"is_adjacent_to_water", 1, 0},
+    {"storage_id", 1, 0},
+    {"sentiment", 1, 1},
+    {"show_on_problem_overlay", 1, 0},
+    {0, 0, 0}
+};
+
+// field layout of figure_save()
+static const record_field FIGURE_FIELDS[] = {
+    {"alternative_location_index", 1, 0},
+    {"image_offset", 1, 0},
+    {"is_enemy_image", 1, 0},
+    {"flotsam_visible", 1, 0},
+    {"image_id", 2, 1},
+    {"cart_image_id", 2, 1},
+    {"next_figure_id_on_same_tile", 2, 1},
+    {"type", 1, 0},
+    {"resource_id", 1, 0},
+    {"use_cross_country", 1, 0},
+    {"is_friendly", 1, 0},
+    {"state", 1, 0},
+    {"faction_id", 1, 0},
+    {"action_state_before_attack", 1, 0},
+    {"direction", 1, 1},
+    {"previous_tile_direction", 1, 1},
+    {"attack_direction", 1, 1},
+    {"x", 1, 0},
+    {"y", 1, 0},
+    {"previous_tile_x", 1, 0},
+    {"previous_tile_y", 1, 0},
+    {"missile_damage", 1, 0},
+    {"damage", 1, 0},
+    {"grid_offset", 2, 1},
+    {"destination_x", 1, 0},
+    {"destination_y", 1, 0},
+    {"destination_grid_offset", 2, 1},
+    {"source_x", 1, 0},
+    {"source_y", 1, 0},
+    {"formation_position_x", 1, 0},
+    {"formation_position_y", 1, 0},
+    {"unused_24", 2, 1},
+    {"wait_ticks", 2, 1},
+    {"action_state", 1, 0},
+    {"progress_on_tile", 1, 0},
+    {"routing_path_id", 2, 1},
+    {"routing_path_current_tile", 2, 1},
+    {"routing_path_length", 2, 1},
+    {"in_building_wait_ticks", 1, 0},
+    {"is_on_road", 1, 0},
+    {"max_roam_length", 2, 1},
+    {"roam_length", 2, 1},
+    {"roam_choose_destination", 1, 0},
+    {"roam_random_counter", 1, 0},
+    {"roam_turn_direction", 1, 1},
+    {"roam_ticks_until_next_turn", 1, 1},
+    {"cross_country_x", 2, 1},
+    {"cross_country_y", 2, 1},
+    {"cc_destination_x", 2, 1},
+    {"cc_destination_y", 2, 1},
+    {"cc_delta_x", 2, 1},
+    {"cc_delta_y", 2, 1},
+    {"cc_delta_xy", 2, 1},
+    {"cc_direction", 1, 0},
+    {"speed_multiplier", 1, 0},
+    {"building_id", 2, 1},
+    {"immigrant_building_id", 2, 1},
+    {"destination_building_id", 2, 1},
+    {"formation_id", 2, 1},
+    {"index_in_formation", 1, 0},
+    {"formation_at_rest", 1, 0},
+    {"migrant_num_people", 1, 0},
+    {"is_ghost", 1, 0},
+    {"min_max_seen", 1, 0},
+    {"unused_57", 1, 0},
+    {"leading_figure_id", 2, 1},
+    {"attack_image_offset", 1, 0},
+    {"wait_ticks_missile", 1, 0},
+    {"x_offset_cart", 1, 1},
+    {"y_offset_cart", 1, 1},
+    {"empire_city_id", 1, 0},
+    {"trader_amount_bought", 1, 0},
+    {"name", 2, 1},
+    {"terrain_usage", 1, 0},
+    {"loads_sold_or_carrying", 1, 0},
+    {"is_boat", 1, 0},
+    {"height_adjusted_ticks", 1, 0},
+    {"current_height", 1, 0},
+    {"target_height", 1, 0},
+    {"collecting_item_id", 1, 0},
+    {"trade_ship_failed_dock_attempts", 1, 0},
+    {"phrase_sequence_exact", 1, 0},
+    {"phrase_id", 1, 1},
+    {"phrase_sequence_city", 1, 0},
+    {"trader_id", 1, 0},
+    {"wait_ticks_next_target", 1, 0},
+    {"unused_6f", 1, 0},
+    {"target_figure_id", 2, 1},
+    {"targeted_by_figure_id", 2, 1},
+    {"created_sequence", 2, 0},
+    {"target_figure_created_sequence", 2, 0},
+    {"figures_on_same_tile_index", 1, 0},
+    {"num_attackers", 1, 0},
+    {"attacker_id1", 2, 1},
+    {"attacker_id2", 2, 1},
+    {"opponent_id", 2, 1},
+    {0, 0, 0}
+};
+
+typedef struct {
+    char *text;
+    int length;
+    int capacity;
+} output;
+
+typedef struct {
+    const char *name;
+    int offset;
+    int length;
+    int record_length;
+    int changed_bytes;
+    int num_changes;
+    int truncated;
+    output out;
+} piece_diff;
+
+static struct {
+    const uint8_t *data1;
+    const uint8_t *data2;
+    piece_diff pieces[MAX_PIECES];
+    int num_pieces;
+} data;
+
+static void append(output *out, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(0, 0, format, args);
+    va_end(args);
+    if (out->length + length + 1 > out->capacity) {
+        int capacity = out->capacity ? out->capacity : 256;
+        while (out->length + length + 1 > capacity) {
+            capacity *= 2;
+        }
+        char *text = (char *) realloc(out->text, capacity);
+        if (!text) {
+            return;
+        }
+        out->text = text;
+        out->capacity = capacity;
+    }
+    va_start(args, format);
+    vsnprintf(&out->text[out->length], out->capacity - out->length, format, args);
+    va_end(args);
+    out->length += length;
+}
+
+static int read_value(const uint8_t *buffer, int size, int is_signed)
+{
+    switch (size) {
+        case 1:
+            return is_signed ? (int8_t) buffer[0] : buffer[0];
+        case 2: {
+            uint16_t value = (uint16_t) (buffer[0] | (buffer[1] << 8));
+            return is_signed ? (int16_t) value : value;
+        }
+        case 4:
+            return (int32_t) (buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t) buffer[3] << 24));
+        default:
+            return 0;
+    }
+}
+
+static int start_change(piece_diff *piece)
+{
+    if (piece->num_changes >= MAX_CHANGES_PER_PIECE) {
+        piece->truncated = 1;
+        return 0;
+    }
+    append(&piece->out, "%s\n        ", piece->num_changes ? "," : "");
+    piece->num_changes++;
+    return 1;
+}
+
+static void diff_record(piece_diff *piece, const record_field *fields, int record, int type_size)
+{
+    const uint8_t *r1 = &data.data1[piece->offset + record * RECORD_SIZE];
+    const uint8_t *r2 = &data.data2[piece->offset + record * RECORD_SIZE];
+    if (memcmp(r1, r2, RECORD_SIZE) == 0) {
+        return;
+    }
+    for (int i = 0; i < RECORD_SIZE; i++) {
+        piece->changed_bytes += r1[i] != r2[i];
+    }
+    if (!start_change(piece)) {
+        return;
+    }
+    // the type is always at offset 10
+    append(&piece->out, "{\"record\": %d, \"type\": [%d, %d], \"fields\": {",
+        record, read_value(&r1[10], type_size, 0), read_value(&r2[10], type_size, 0));
+    int offset = 0;
+    int num_fields = 0;
+    for (const record_field *field = fields; field->name; offset += field->size, field++) {
+        if (memcmp(&r1[offset], &r2[offset], field->size) == 0) {
+            continue;
+        }
+        if (field->size > 4) {
+            for (int i = 0; i < field->size; i++) {
+                if (r1[offset + i] != r2[offset + i]) {
+                    append(&piece->out, "%s\"%s[%d]\": [%d, %d]", num_fields++ ? ", " : "",
+                        field->name, i, r1[offset + i], r2[offset + i]);
+                }
+            }
+        } else {
+            append(&piece->out, "%s\"%s\": [%d, %d]", num_fields++ ? ", " : "", field->name,
+                read_value(&r1[offset], field->size, field->is_signed),
+                read_value(&r2[offset], field->size, field->is_signed));
+        }
+    }
+    append(&piece->out, "}}");
+}
+
+static void diff_grid(piece_diff *piece)
+{
+    int tile_size = piece->length / (GRID_SIZE * GRID_SIZE);
+    const uint8_t *grid1 = &data.data1[piece->offset];
+    const uint8_t *grid2 = &data.data2[piece->offset];
+    for (int tile = 0; tile < GRID_SIZE * GRID_SIZE; tile++) {
+        int position = tile * tile_size;
+        if (memcmp(&grid1[position], &grid2[position], tile_size) == 0) {
+            continue;
+        }
+        for (int i = 0; i < tile_size; i++) {
+            piece->changed_bytes += grid1[position + i] != grid2[position + i];
+        }
+        if (start_change(piece)) {
+            append(&piece->out, "{\"x\": %d, \"y\": %d, \"values\": [%d, %d]}",
+                tile % GRID_SIZE, tile / GRID_SIZE,
+                read_value(&grid1[position], tile_size, 0), read_value(&grid2[position], tile_size, 0));
+        }
+    }
+}
+
+static void diff_bytes(piece_diff *piece)
+{
+    const uint8_t *bytes1 = &data.data1[piece->offset];
+    const uint8_t *bytes2 = &data.data2[piece->offset];
+    for (int i = 0; i < piece->length; i++) {
+        if (bytes1[i] == bytes2[i]) {
+            continue;
+        }
+        piece->changed_bytes++;
+        if (!start_change(piece)) {
+            continue;
+        }
+        if (piece->record_length) {
+            append(&piece->out, "{\"record\": %d, \"offset\": %d, \"values\": [%d, %d]}",
+                i / piece->record_length, i % piece->record_length, bytes1[i], bytes2[i]);
+        } else {
+            append(&piece->out, "{\"offset\": %d, \"values\": [%d, %d]}", i, bytes1[i], bytes2[i]);
+        }
+    }
+}
+
+static int is_grid(const piece_diff *piece)
+{
+    int name_length = (int) strlen(piece->name);
+    return name_length > 5 && strcmp(&piece->name[name_length - 5], "_grid") == 0 &&
+        piece->length % (GRID_SIZE * GRID_SIZE) == 0;
+}
+
+static void diff_piece(int index, void *unused)
+{
+    piece_diff *piece = &data.pieces[index];
+    if (memcmp(&data.data1[piece->offset], &data.data2[piece->offset], piece->length) == 0) {
+        return;
+    }
+    if (strcmp(piece->name, "buildings") == 0) {
+        for (int i = 0; i < piece->length / RECORD_SIZE; i++) {
+            diff_record(piece, BUILDING_FIELDS, i, 2);
+        }
+    } else if (strcmp(piece->name, "figures") == 0) {
+        for (int i = 0; i < piece->length / RECORD_SIZE; i++) {
+            diff_record(piece, FIGURE_FIELDS, i, 1);
+        }
+    } else if (is_grid(piece)) {
+        diff_grid(piece);
+    } else {
+        diff_bytes(piece);
+    }
+}
+
+static int init_pieces(int size)
+{
+    int offset = 0;
+    data.num_pieces = 0;
+    for (int i = 0; i < MAX_PIECES; i++) {
+        piece_diff *piece = &data.pieces[i];
+        piece->out.length = 0;
+        piece->changed_bytes = 0;
+        piece->num_changes = 0;
+        piece->truncated = 0;
+        if (!get_savegame_part(i, &piece->name, &piece->length, &piece->record_length)) {
+            break;
+        }
+        piece->offset = offset;
+        offset += piece->length;
+        data.num_pieces++;
+    }
+    if (offset < size && data.num_pieces < MAX_PIECES) {
+        // the padding written after the last piece is not part of the table
+        piece_diff *piece = &data.pieces[data.num_pieces++];
+        piece->name = "end_marker";
+        piece->offset = offset;
+        piece->length = size - offset;
+        piece->record_length = 0;
+        piece->out.length = 0;
+        piece->changed_bytes = 0;
+        piece->num_changes = 0;
+        piece->truncated = 0;
+        offset = size;
+    }
+    return offset == size;
+}
+
+static void print_string(const char *value)
+{
+    putchar('"');
+    for (; *value; value++) {
+        if (*value == '"' || *value == '\\') {
+            putchar('\\');
+        }
+        putchar(*value);
+    }
+    putchar('"');
+}
+
+static int print_diff(void)
+{
+    int num_changed = 0;
+    printf(", \"pieces\": [");
+    for (int i = 0; i < data.num_pieces; i++) {
+        piece_diff *piece = &data.pieces[i];
+        if (!piece->changed_bytes) {
+            continue;
+        }
+        printf("%s\n    {\"piece\": ", num_changed++ ? "," : "");
+        print_string(piece->name);
+        printf(", \"index\": %d, \"changed_bytes\": %d, \"truncated\": %s, \"changes\": [%.*s\n    ]}",
+            i, piece->changed_bytes, piece->truncated ? "true" : "false",
+            piece->out.length, piece->out.text ? piece->out.text : "");
+    }
+    printf("%s]", num_changed ? "\n  " : "");
+    return num_changed;
+}
+
+static int diff_files(const char *file1, const char *file2)
+{
+    printf("  {\"file1\": ");
+    print_string(file1);
+    printf(", \"file2\": ");
+    print_string(file2);
+
+    int size1 = 0;
+    int size2 = 0;
+    uint8_t *data1 = game_file_io_read_saved_game_pieces(file1, &size1);
+    uint8_t *data2 = game_file_io_read_saved_game_pieces(file2, &size2);
+    int result;
+    if (!data1 || !data2) {
+        printf(", \"error\": \"unable to read saved game\"}");
+        result = 1;
+    } else if (size1 != size2 || !init_pieces(size1)) {
+        printf(", \"error\": \"unknown saved game layout\"}");
+        result = 1;
+    } else {
+        data.data1 = data1;
+        data.data2 = data2;
+        parallel_for(data.num_pieces, diff_piece, 0);
+        result = print_diff() ? 1 : 0;
+        printf("}");
+    }
+    free(data1);
+    free(data2);
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc % 2 == 0) {
+        printf("Usage: %s FILE1 FILE2 [FILE1 FILE2]...\n", argv[0]);
+        printf("Prints the differences between pairs of saved games as JSON\n");
+        return 2;
+    }
+    int different = 0;
+    printf("[\n");
+    for (int i = 1; i < argc; i += 2) {
+        different |= diff_files(argv[i], argv[i + 1]);
+        printf("%s\n", i + 2 < argc ? "," : "");
+    }
+    printf("]\n");
+    for (int i = 0; i < data.num_pieces; i++) {
+        free(data.pieces[i].out.text);
+    }
+    return different;
+}
@@ -0,0 +1,81 @@
+#include "core/time.h"
+#include "game/file.h"
+#include "game/game.h"
+#include "game/settings.h"
+#include "game/speed.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sav_compare.h"
+
+static void run_ticks(int ticks)
+{
+    // every run starts from the same clock, so the number of ticks per frame does not depend on earlier runs
+    time_set_millis(0);
+    game_speed_reset();
+    setting_reset_speeds(500, setting_scroll_speed());
+    for (int i = 1; i <= ticks; i++) {
+        time_set_millis(2 * i);
+        game_run();
+    }
+}
+
+static int run_from_snapshot(const game_snapshot *snapshot, const char *output_saved_game, int ticks)
+{
+    if (!game_file_restore_snapshot(snapshot)) {
+        printf("Unable to restore snapshot\n");
+        return 0;
+    }
+    run_ticks(ticks);
+    return game_file_write_saved_game(output_saved_game);
+}
+
+static int check_snapshot(const char *input_saved_game, const char *output_prefix, int ticks,
+    const char *expected_saved_game)
+{
+    char first_output[300];
+    char second_output[300];
+    snprintf(first_output, 300, "%s-first.sav", output_prefix);
+    snprintf(second_output, 300, "%s-second.sav", output_prefix);
+
+    if (!game_pre_init() || !game_init()) {
+        printf("Unable to initialize game\n");
+        return 1;
+    }
+    if (!game_file_load_saved_game(input_saved_game)) {
+        printf("Unable to load saved game %s\n", input_saved_game);
+        return 1;
+    }
+    game_snapshot *snapshot = game_file_create_snapshot();
+    if (!snapshot) {
+        printf("Unable to create snapshot\n");
+        return 1;
+    }
+    // run the same ticks twice from the snapshot, with a second snapshot in between
+    run_ticks(ticks);
+    game_snapshot *later = game_file_create_snapshot();
+    int ok = later && run_from_snapshot(snapshot, first_output, ticks) &&
+        game_file_restore_snapshot(later) && run_from_snapshot(snapshot, second_output, ticks);
+    game_file_free_snapshot(later);
+    game_file_free_snapshot(snapshot);
+    game_exit();
+    if (!ok) {
+        printf("Unable to run from snapshot\n");
+        return 1;
+    }
+    // the first run must match a normal run from the saved game, the second run the first
+    int result = compare_files(expected_saved_game, first_output);
+    if (result) {
+        return result;
+    }
+    return compare_files(first_output, second_output);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 5) {
+        printf("Usage: snapshotcheck <input sav> <output prefix> <ticks> <expected sav>\n");
+        return -1;
+    }
+    return check_snapshot(argv[1], argv[2], atoi(argv[3]), argv[4]);
+}
@@ -0,0 +1,80 @@
+#include "sav_compare.h"
+
+#include "../src/core/zip.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BUFFER_SIZE 600000
+#define NUM_LEVELS 3
+
+static const char *LEVEL_NAMES[NUM_LEVELS] = {"fast", "normal", "best"};
+
+static unsigned char compressed[BUFFER_SIZE];
+static unsigned char decompressed[BUFFER_SIZE];
+
+static struct {
+    int errors;
+    long long input_bytes;
+    long long output_bytes[NUM_LEVELS];
+    clock_t compress_time[NUM_LEVELS];
+    clock_t decompress_time[NUM_LEVELS];
+} data;
+
+static void check_part(const char *name, const unsigned char *part, int length)
+{
+    data.input_bytes += length;
+    for (int level = 0; level < NUM_LEVELS; level++) {
+        int compressed_length = BUFFER_SIZE;
+        clock_t start = clock();
+        if (!zip_compress_level(part, length, compressed, &compressed_length, (zip_level) level)) {
+            printf("ERROR: unable to compress %s with level %s\n", name, LEVEL_NAMES[level]);
+            data.errors++;
+            continue;
+        }
+        clock_t middle = clock();
+        int decompressed_length = BUFFER_SIZE;
+        if (!zip_decompress(compressed, compressed_length, decompressed, &decompressed_length)) {
+            printf("ERROR: unable to decompress %s with level %s\n", name, LEVEL_NAMES[level]);
+            data.errors++;
+            continue;
+        }
+        clock_t end = clock();
+        if (decompressed_length != length || memcmp(part, decompressed, length) != 0) {
+            printf("ERROR: round trip of %s with level %s gives different data\n", name, LEVEL_NAMES[level]);
+            data.errors++;
+        }
+        data.output_bytes[level] += compressed_length;
+        data.compress_time[level] += middle - start;
+        data.decompress_time[level] += end - middle;
+    }
+}
+
+static double megabytes_per_second(long long bytes, clock_t time)
+{
+    if (time <= 0) {
+        time = 1;
+    }
+    return bytes / (1024.0 * 1024.0) / ((double) time / CLOCKS_PER_SEC);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Usage: %s FILE...\n", argv[0]);
+        return 1;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (!for_each_compressed_part(argv[i], check_part)) {
+            return 1;
+        }
+    }
+    for (int level = 0; level < NUM_LEVELS; level++) {
+        printf("Level %-6s: ratio %5.2f%%, compress %7.2f MB/s, decompress %7.2f MB/s\n",
+            LEVEL_NAMES[level], 100.0 * data.output_bytes[level] / data.input_bytes,
+            megabytes_per_second(data.input_bytes, data.compress_time[level]),
+            megabytes_per_second(data.input_bytes, data.decompress_time[level]));
+    }
+    return data.errors ? 1 : 0;
+}
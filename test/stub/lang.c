@@ -1,6 +1,7 @@
 #include "core/encoding.h"
 #include "core/lang.h"
 #include "graphics/font.h"
+#include "graphics/text.h"
 #include "translation/translation.h"
 
 static uint8_t EMPTY[] = {0};
@@ -26,5 +27,8 @@ const lang_message *lang_get_message(int id)
 void font_set_encoding(encoding_type encoding)
 {}
 
+void text_invalidate_cache(void)
+{}
+
 void translation_load(language_type language)
 {}
@@ -25,6 +25,9 @@ int sound_device_play_music(const char *filename, int volume_pct)
     return 0;
 }
 
+void sound_device_prefetch_music(const char *filename)
+{}
+
 void sound_device_play_file_on_channel(const char *filename, int channel, int volume_pct)
 {}
 
@@ -1,4 +1,5 @@
 #include "graphics/window.h"
+#include "widget/city_with_overlay.h"
 #include "widget/minimap.h"
 #include "window/building_info.h"
 #include "window/editor/map.h"
@@ -63,6 +64,9 @@ void window_popup_dialog_show(popup_dialog_type type, void (*okFunc)(int), int h
 void widget_minimap_invalidate(void)
 {}
 
+void city_with_overlay_invalidate(void)
+{}
+
 int window_building_info_get_building_type(void)
 {
     return 0;
@@ -0,0 +1,70 @@
+#include "../src/core/smacker.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define NUM_RUNS 3
+
+static int decode_video(const char *filename, int *num_frames, clock_t *time)
+{
+    smacker s = smacker_open(fopen(filename, "rb"));
+    if (!s) {
+        printf("ERROR: unable to open %s\n", filename);
+        return 0;
+    }
+    int frames;
+    smacker_get_frames_info(s, &frames, 0);
+    clock_t start = clock();
+    smacker_frame_status status = smacker_first_frame(s);
+    int decoded = 0;
+    while (status == SMACKER_FRAME_OK) {
+        decoded++;
+        status = smacker_next_frame(s);
+    }
+    *time += clock() - start;
+    *num_frames += decoded;
+    smacker_close(s);
+    if (status == SMACKER_FRAME_ERROR) {
+        printf("ERROR: unable to decode frame %d of %s\n", decoded, filename);
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Usage: %s FILE.smk...\n", argv[0]);
+        return 1;
+    }
+    int errors = 0;
+    for (int i = 1; i < argc; i++) {
+        smacker s = smacker_open(fopen(argv[i], "rb"));
+        if (!s) {
+            printf("ERROR: unable to open %s\n", argv[i]);
+            errors++;
+            continue;
+        }
+        int width, height, us_per_frame;
+        smacker_get_video_info(s, &width, &height, 0);
+        smacker_get_frames_info(s, 0, &us_per_frame);
+        smacker_close(s);
+
+        int num_frames = 0;
+        clock_t time = 0;
+        for (int run = 0; run < NUM_RUNS; run++) {
+            if (!decode_video(argv[i], &num_frames, &time)) {
+                errors++;
+                break;
+            }
+        }
+        if (time <= 0) {
+            time = 1;
+        }
+        double frames_per_second = num_frames / ((double) time / CLOCKS_PER_SEC);
+        printf("%s: %dx%d, %8.1f frames/s, %6.1fx real time, %7.2f Mpixels/s\n",
+            argv[i], width, height, frames_per_second, frames_per_second * us_per_frame / 1000000.0,
+            frames_per_second * width * height / 1000000.0);
+    }
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+#include "../src/core/smacker.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+static uint32_t hash_data(uint32_t hash, const void *data, int size)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    for (int i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t frame_checksum(smacker s, int width, int height)
+{
+    uint32_t hash = hash_data(2166136261u, smacker_get_frame_video(s), width * height);
+    return hash_data(hash, smacker_get_frame_palette(s), 256 * sizeof(color_t));
+}
+
+static int check_video(const char *filename, FILE *expected)
+{
+    smacker s = smacker_open(fopen(filename, "rb"));
+    if (!s) {
+        printf("ERROR: unable to open %s\n", filename);
+        return 1;
+    }
+    int width, height, num_frames;
+    smacker_get_video_info(s, &width, &height, 0);
+    smacker_get_frames_info(s, &num_frames, 0);
+
+    int errors = 0;
+    smacker_frame_status status = smacker_first_frame(s);
+    for (int frame = 0; frame < num_frames; frame++) {
+        if (status != SMACKER_FRAME_OK) {
+            printf("ERROR: unable to decode frame %d\n", frame);
+            errors++;
+            break;
+        }
+        uint32_t checksum = frame_checksum(s, width, height);
+        if (!expected) {
+            printf("%d %08x\n", frame, (unsigned int) checksum);
+        } else {
+            int expected_frame;
+            unsigned int expected_checksum;
+            if (fscanf(expected, "%d %x", &expected_frame, &expected_checksum) != 2 || expected_frame != frame) {
+                printf("ERROR: no checksum for frame %d\n", frame);
+                errors++;
+                break;
+            }
+            if (checksum != expected_checksum) {
+                printf("ERROR: frame %d has checksum %08x, expected %08x\n",
+                    frame, (unsigned int) checksum, expected_checksum);
+                errors++;
+            }
+        }
+        status = smacker_next_frame(s);
+    }
+    if (!errors && status != SMACKER_FRAME_DONE) {
+        printf("ERROR: video does not end after %d frames\n", num_frames);
+        errors++;
+    }
+    smacker_close(s);
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3) {
+        printf("Usage: %s FILE.smk [CHECKSUMS.txt]\n", argv[0]);
+        printf("Without checksums file, prints the checksum of every frame\n");
+        return 1;
+    }
+    FILE *expected = 0;
+    if (argc == 3) {
+        expected = fopen(argv[2], "r");
+        if (!expected) {
+            printf("ERROR: unable to open %s\n", argv[2]);
+            return 1;
+        }
+    }
+    int errors = check_video(argv[1], expected);
+    if (expected) {
+        fclose(expected);
+    }
+    if (!errors && expected) {
+        printf("All frames match\n");
+    }
+    return errors ? 1 : 0;
+}